@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include <cstdint>
 #include <functional>
 #include <span>
@@ -16,7 +17,21 @@ public:
 
     virtual bool init() = 0;
     virtual bool pump_events() = 0;
+    /* Blocks until a platform event arrived, wake() was called or timeout_ms
+       passed, -1 waits without a timeout */
+    virtual void wait_events(int timeout_ms) = 0;
+    /* Called from any thread */
+    virtual void wake() = 0;
     virtual void present(Canvas& canvas, std::span<const IntRect> dirty_rects) = 0;
+    /* Points canvas, created over external memory, at the display buffer
+       the next frame should be drawn into and presented from. False when
+       frames have to be drawn into a canvas of their own and copied. */
+    virtual bool attach_back_buffer(Canvas& canvas) = 0;
+    /* steady_clock time of the vsync the last present() went out on, a
+       default constructed time_point if the platform can't tell */
+    virtual std::chrono::steady_clock::time_point last_vsync() const = 0;
+    /* Zero if unknown */
+    virtual std::chrono::nanoseconds refresh_period() const = 0;
     virtual void quit(int exit_code) = 0;
     virtual void show() = 0;
 
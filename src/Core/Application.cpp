@@ -51,12 +51,40 @@ bool Application::pump_events() {
     return m_backend ? m_backend->pump_events() : false;
 }
 
+void Application::wait_events(int timeout_ms) {
+    if (!m_backend) return;
+    // A pending wake only needs its fd or event drained
+    m_backend->wait_events(m_wake_pending.load(std::memory_order_acquire) ? 0 : timeout_ms);
+    m_wake_pending.store(false, std::memory_order_release);
+}
+
+void Application::wake() {
+    Application* app = _instance;
+    if (!app || !app->m_backend) return;
+    // Many producers wake once per wait, not once per event
+    if (!app->m_wake_pending.exchange(true, std::memory_order_acq_rel)) {
+        app->m_backend->wake();
+    }
+}
+
 void Application::present(Canvas& canvas, std::span<const IntRect> dirty_rects) {
     if (m_backend) {
         m_backend->present(canvas, dirty_rects);
     }
 }
 
+bool Application::attach_back_buffer(Canvas& canvas) {
+    return m_backend && m_backend->attach_back_buffer(canvas);
+}
+
+std::chrono::steady_clock::time_point Application::last_vsync() const {
+    return m_backend ? m_backend->last_vsync() : std::chrono::steady_clock::time_point{};
+}
+
+std::chrono::nanoseconds Application::refresh_period() const {
+    return m_backend ? m_backend->refresh_period() : std::chrono::nanoseconds::zero();
+}
+
 void Application::on_resize(std::function<void(int, int)> callback) {
     m_on_resize = std::move(callback);
 }
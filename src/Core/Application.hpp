@@ -1,5 +1,7 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <functional>
 #include <memory>
@@ -22,8 +24,17 @@ public:
     bool init();
 
     bool pump_events();
+    /* Sleeps until there is input, a post from another thread or timeout_ms
+       passed, -1 waits without a timeout */
+    void wait_events(int timeout_ms);
+    /* Thread-safe, ends the current or next wait_events() */
+    static void wake();
 
     void present(Canvas& canvas, std::span<const IntRect> dirty_rects = {});
+    /* Zero-copy presenting, see AppImplementation::attach_back_buffer() */
+    bool attach_back_buffer(Canvas& canvas);
+    std::chrono::steady_clock::time_point last_vsync() const;
+    std::chrono::nanoseconds refresh_period() const;
 
     uint32_t width() const { return m_width; }
     uint32_t height() const { return m_height; }
@@ -47,6 +58,7 @@ private:
     uint32_t m_width{0};
     uint32_t m_height{0};
     std::function<void(int, int)> m_on_resize;
+    std::atomic<bool> m_wake_pending{false};
     std::unique_ptr<AppImplementation> m_backend{nullptr};
     static Application* _instance;
 };
@@ -0,0 +1,204 @@
+#include "Core/AssetWatcher.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/poll.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Core/ResourceManager.hpp"
+#include "Core/ResourcePack.hpp"
+#include "Core/TaskPool.hpp"
+#include "Core/ThemeDB.hpp"
+#include "Core/ViewManager.hpp"
+#include "Debug/Logger.hpp"
+#include "Graphics/Font.hpp"
+#include "Graphics/Image.hpp"
+
+namespace Izo {
+
+static constexpr const char* kWatchedDirs[] = {"themes", "fonts", "icons"};
+
+static uint64_t hash_file(const std::string& path) {
+    // FNV-1a, only used to tell whether a rewritten file really changed
+    uint64_t hash = 1469598103934665603ull;
+    std::ifstream file(path, std::ios::binary);
+    char buffer[16 * 1024];
+    while (file.read(buffer, sizeof(buffer)) || file.gcount() > 0) {
+        for (std::streamsize i = 0; i < file.gcount(); ++i) {
+            hash ^= static_cast<uint8_t>(buffer[i]);
+            hash *= 1099511628211ull;
+        }
+    }
+    return hash;
+}
+
+AssetWatcher& AssetWatcher::the() {
+    static AssetWatcher g_instance;
+    return g_instance;
+}
+
+AssetWatcher::~AssetWatcher() {
+    stop();
+}
+
+void AssetWatcher::start() {
+    if (m_running) return;
+
+    m_wake_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (m_wake_fd < 0) {
+        LogError("AssetWatcher: Failed to create eventfd");
+        return;
+    }
+
+    // Ends with a slash, see ResourceManagerBase::set_resource_root()
+    m_root = ResourceManagerBase::resource_root();
+    m_running = true;
+    m_worker_thread = std::thread(&AssetWatcher::run_thread, this);
+}
+
+void AssetWatcher::stop() {
+    if (!m_running) return;
+
+    m_running = false;
+    uint64_t one = 1;
+    [[maybe_unused]] auto written = write(m_wake_fd, &one, sizeof(one));
+    if (m_worker_thread.joinable()) {
+        m_worker_thread.join();
+    }
+    close(m_wake_fd);
+    m_wake_fd = -1;
+}
+
+bool AssetWatcher::refresh_stamp(const std::string& path) {
+    std::string full_path = m_root + path;
+
+    struct stat st;
+    if (stat(full_path.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) {
+        return false;
+    }
+
+    int64_t mtime_ns = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+    auto it = m_stamps.find(path);
+    if (it != m_stamps.end() && it->second.mtime_ns == mtime_ns) {
+        return false;
+    }
+
+    uint64_t hash = hash_file(full_path);
+    bool changed = it == m_stamps.end() || it->second.hash != hash;
+    m_stamps[path] = {mtime_ns, hash};
+    return changed;
+}
+
+void AssetWatcher::run_thread() {
+    int inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify_fd < 0) {
+        LogError("AssetWatcher: Failed to initialize inotify");
+        return;
+    }
+
+    // Editors either rewrite the file or move a temporary over it
+    std::map<int, std::string> watches;
+    for (const char* dir : kWatchedDirs) {
+        std::string full_path = m_root + dir;
+        int wd = inotify_add_watch(inotify_fd, full_path.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+        if (wd < 0) {
+            LogWarn("AssetWatcher: Unable to watch '{}'", full_path);
+            continue;
+        }
+        watches[wd] = dir;
+
+        // Baseline so that the first write of identical content is ignored
+        std::error_code ec;
+        for (const auto& entry : std::filesystem::directory_iterator(full_path, ec)) {
+            if (entry.is_regular_file()) {
+                refresh_stamp(std::string(dir) + "/" + entry.path().filename().string());
+            }
+        }
+    }
+    LogInfo("AssetWatcher: Watching {} resource directories", watches.size());
+
+    alignas(struct inotify_event) char buffer[4096];
+    auto deadline = std::chrono::steady_clock::time_point::max();
+
+    while (m_running) {
+        int timeout_ms = -1;
+        if (!m_pending.empty()) {
+            auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+            timeout_ms = std::max<int>(0, static_cast<int>(remaining.count()));
+        }
+
+        pollfd fds[2] = {{inotify_fd, POLLIN, 0}, {m_wake_fd, POLLIN, 0}};
+        int ret = poll(fds, 2, timeout_ms);
+        if (ret < 0 && errno != EINTR) break;
+        if (!m_running) break;
+
+        if (ret > 0 && (fds[0].revents & POLLIN)) {
+            ssize_t len;
+            while ((len = read(inotify_fd, buffer, sizeof(buffer))) > 0) {
+                for (char* ptr = buffer; ptr < buffer + len;) {
+                    auto* event = reinterpret_cast<inotify_event*>(ptr);
+                    auto dir_it = watches.find(event->wd);
+                    if (dir_it != watches.end() && event->len > 0) {
+                        m_pending.insert(dir_it->second + "/" + event->name);
+                    }
+                    ptr += sizeof(inotify_event) + event->len;
+                }
+            }
+            // Every new event pushes the deadline, so a burst reloads once
+            deadline = std::chrono::steady_clock::now() + kDebounce;
+        }
+
+        if (m_pending.empty() || std::chrono::steady_clock::now() < deadline) continue;
+
+        std::vector<std::string> changed;
+        for (const auto& path : m_pending) {
+            if (refresh_stamp(path)) changed.push_back(path);
+        }
+        m_pending.clear();
+
+        for (const auto& path : changed) {
+            TaskPool::the().post_to_ui([this, path]() { reload(path); });
+        }
+    }
+
+    close(inotify_fd);
+    LogInfo("AssetWatcher: Stopped");
+}
+
+void AssetWatcher::reload(const std::string& path) {
+    ResourcePack::the().override_entry(path);
+
+    if (path == ThemeDB::the().path()) {
+        LogInfo("AssetWatcher: Reloading theme '{}'", path);
+        ThemeDB::the().reload();
+        return;
+    }
+
+    // Other fonts keep their old glyphs until they are evicted and loaded again
+    auto fonts = FontManager::the().names_for_path(path);
+    if (std::find(fonts.begin(), fonts.end(), "system-ui") != fonts.end()) {
+        LogInfo("AssetWatcher: Reloading font '{}'", path);
+        ThemeDB::the().reload_fonts();
+        return;
+    }
+
+    auto images = ImageManager::the().names_for_path(path);
+    if (!images.empty()) {
+        LogInfo("AssetWatcher: Reloading image '{}'", path);
+        // Widgets keep the Image pointer, so replace the pixels in place.
+        // Evicted images are read from the new file on their next use.
+        ResourceManagerBase::wait_for_readers();
+        for (const auto& name : images) {
+            if (Image* image = ImageManager::the().find_loaded(name)) {
+                image->reload(m_root + path);
+            }
+        }
+        ViewManager::the().invalidate_full();
+    }
+}
+
+}
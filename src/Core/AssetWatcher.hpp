@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Izo {
+
+/* Watches themes/, fonts/ and icons/ below the resource root with inotify.
+   Bursts of writes are debounced on a worker thread and files whose
+   content did not change are dropped; the rest are reloaded by jobs posted
+   to the UI thread through TaskPool. */
+class AssetWatcher {
+public:
+    static AssetWatcher& the();
+
+    void start();
+    void stop();
+
+private:
+    AssetWatcher() = default;
+    ~AssetWatcher();
+
+    struct FileStamp {
+        int64_t mtime_ns = 0;
+        uint64_t hash = 0;
+    };
+
+    void run_thread();
+    /* Whether the file at the relative path differs from the last seen version */
+    bool refresh_stamp(const std::string& path);
+    /* Runs on the UI thread */
+    void reload(const std::string& path);
+
+    static constexpr std::chrono::milliseconds kDebounce{30};
+
+    std::string m_root;
+    std::map<std::string, FileStamp> m_stamps;  // worker thread only
+    std::set<std::string> m_pending;            // worker thread only
+
+    int m_wake_fd = -1;
+    std::atomic<bool> m_running{false};
+    std::thread m_worker_thread;
+};
+
+}
@@ -0,0 +1,149 @@
+#include "Core/BootGraph.hpp"
+
+#include <algorithm>
+#include <optional>
+
+#include "Core/TaskPool.hpp"
+#include "Debug/BootProfiler.hpp"
+#include "Debug/Logger.hpp"
+
+namespace Izo {
+
+BootGraph::StepId BootGraph::add(std::string name, Thread thread, Step step, std::vector<StepId> dependencies) {
+    StepId id = m_nodes.size();
+    for (StepId dependency : dependencies) {
+        if (dependency >= id) {
+            LogFatal("BootGraph: '{}' depends on a step that was not added yet", name);
+        }
+    }
+    m_nodes.push_back({std::move(name), thread, std::move(step), std::move(dependencies)});
+    return id;
+}
+
+void BootGraph::finish(StepId id, bool ok) {
+    Node& node = m_nodes[id];
+    node.end = std::chrono::steady_clock::now();
+    node.state = ok ? State::Done : State::Failed;
+    if (!ok) {
+        LogError("BootGraph: Step '{}' failed", node.name);
+    }
+    if (m_on_step_finished) {
+        m_on_step_finished(node.name);
+    }
+}
+
+bool BootGraph::run() {
+    size_t remaining = m_nodes.size();
+    bool all_ok = true;
+
+    while (remaining > 0) {
+        // Worker results first, they may unblock UI steps
+        std::vector<std::pair<StepId, bool>> results;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            results.swap(m_worker_results);
+        }
+        for (auto [id, ok] : results) {
+            finish(id, ok);
+            all_ok &= ok;
+            --remaining;
+        }
+
+        std::optional<StepId> ui_step;
+        for (StepId id = 0; id < m_nodes.size(); ++id) {
+            Node& node = m_nodes[id];
+            if (node.state != State::Pending) continue;
+
+            bool ready = true;
+            bool skip = false;
+            for (StepId dependency : node.dependencies) {
+                State state = m_nodes[dependency].state;
+                if (state == State::Failed || state == State::Skipped) skip = true;
+                if (state != State::Done) ready = false;
+            }
+
+            if (skip) {
+                LogWarn("BootGraph: Skipping '{}'", node.name);
+                node.state = State::Skipped;
+                all_ok = false;
+                --remaining;
+                continue;
+            }
+            if (!ready) continue;
+
+            if (node.thread == Thread::Worker) {
+                node.state = State::Running;
+                node.start = std::chrono::steady_clock::now();
+                TaskPool::the().run_async([this, id]() {
+                    bool ok;
+                    {
+                        BootProfiler::Phase phase(m_nodes[id].name);
+                        ok = m_nodes[id].step();
+                    }
+                    {
+                        std::lock_guard<std::mutex> lock(m_mutex);
+                        m_worker_results.emplace_back(id, ok);
+                    }
+                    m_worker_done.notify_one();
+                });
+            } else if (!ui_step) {
+                ui_step = id;
+            }
+        }
+
+        if (ui_step) {
+            Node& node = m_nodes[*ui_step];
+            node.state = State::Running;
+            node.start = std::chrono::steady_clock::now();
+            bool ok;
+            {
+                BootProfiler::Phase phase(node.name);
+                ok = node.step();
+            }
+            finish(*ui_step, ok);
+            all_ok &= ok;
+            --remaining;
+            continue;
+        }
+
+        if (remaining == 0) break;
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_worker_done.wait(lock, [this] { return !m_worker_results.empty(); });
+    }
+
+    report_critical_path();
+    return all_ok;
+}
+
+void BootGraph::report_critical_path() const {
+    // Walk back from the step that finished last, always through the
+    // dependency that finished last
+    std::optional<StepId> current;
+    for (StepId id = 0; id < m_nodes.size(); ++id) {
+        if (m_nodes[id].state != State::Done && m_nodes[id].state != State::Failed) continue;
+        if (!current || m_nodes[id].end > m_nodes[*current].end) current = id;
+    }
+    if (!current) return;
+
+    auto end = m_nodes[*current].end;
+    auto start = m_nodes[*current].start;
+    std::vector<std::string> path;
+    while (current) {
+        const Node& node = m_nodes[*current];
+        path.push_back(node.name);
+        start = node.start;
+
+        std::optional<StepId> previous;
+        for (StepId dependency : node.dependencies) {
+            if (!previous || m_nodes[dependency].end > m_nodes[*previous].end) previous = dependency;
+        }
+        current = previous;
+    }
+    std::reverse(path.begin(), path.end());
+
+    auto wall_us = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+    BootProfiler::the().set_critical_path(std::move(path), wall_us);
+}
+
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Izo {
+
+/* Boot steps and what they depend on. run() starts each step as soon as
+   its dependencies finished, Worker steps on the TaskPool and UI steps on
+   the calling thread. ThemeDB, the resource managers, ViewManager and the
+   widgets are not thread-safe: steps touching the same ones must be ordered
+   through dependencies. */
+class BootGraph {
+public:
+    enum class Thread {
+        UI,
+        Worker,
+    };
+
+    /* Returns false on failure, steps depending on it are skipped then */
+    using Step = std::function<bool()>;
+    using StepId = size_t;
+
+    /* Dependencies have to be added first, which rules out cycles */
+    StepId add(std::string name, Thread thread, Step step, std::vector<StepId> dependencies = {});
+
+    /* Runs on the calling thread of run() whenever a step finished */
+    void on_step_finished(std::function<void(const std::string& name)> callback) { m_on_step_finished = std::move(callback); }
+
+    size_t size() const { return m_nodes.size(); }
+
+    /* Blocks until every step finished or was skipped, false if any failed */
+    bool run();
+
+private:
+    enum class State {
+        Pending,
+        Running,
+        Done,
+        Failed,
+        Skipped,
+    };
+
+    struct Node {
+        std::string name;
+        Thread thread;
+        Step step;
+        std::vector<StepId> dependencies;
+        State state = State::Pending;
+        std::chrono::steady_clock::time_point start;
+        std::chrono::steady_clock::time_point end;
+    };
+
+    void finish(StepId id, bool ok);
+    void report_critical_path() const;
+
+    std::vector<Node> m_nodes;
+    std::function<void(const std::string&)> m_on_step_finished;
+
+    std::mutex m_mutex;
+    std::condition_variable m_worker_done;
+    std::vector<std::pair<StepId, bool>> m_worker_results;
+};
+
+}
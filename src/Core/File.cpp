@@ -3,10 +3,64 @@
 #include <sstream>
 #include <filesystem>
 #include <system_error>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include "Debug/Logger.hpp"
 
 namespace Izo {
 
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : m_data(std::exchange(other.m_data, nullptr)), m_size(std::exchange(other.m_size, 0)) {}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        if (m_data) munmap(m_data, m_size);
+        m_data = std::exchange(other.m_data, nullptr);
+        m_size = std::exchange(other.m_size, 0);
+    }
+    return *this;
+}
+
+MappedFile::~MappedFile() {
+    if (m_data) munmap(m_data, m_size);
+}
+
+void MappedFile::advise(Access access) const {
+    if (!m_data) return;
+    int advice = MADV_NORMAL;
+    switch (access) {
+        case Access::Normal: advice = MADV_NORMAL; break;
+        case Access::Sequential: advice = MADV_SEQUENTIAL; break;
+        case Access::Random: advice = MADV_RANDOM; break;
+        case Access::WillNeed: advice = MADV_WILLNEED; break;
+    }
+    // Only a hint, the mapping works the same without it
+    madvise(m_data, m_size, advice);
+}
+
+MappedFile File::map(const std::string& path, MappedFile::Access access) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return {};
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return {};
+    }
+
+    size_t size = static_cast<size_t>(st.st_size);
+    void* data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return {};
+
+    MappedFile file(data, size);
+    file.advise(access);
+    return file;
+}
+
 std::string File::read_all_text(const std::string& path) {
     std::ifstream f(path);
     if (!f.is_open()) return "";
@@ -1,13 +1,54 @@
 #pragma once
 
 #include <string>
+#include <string_view>
+#include <span>
 #include <vector>
 #include <cstdint>
 
 namespace Izo {
 
+/* Read-only mapping of a whole file. Pages come from the page cache and are
+   shared with every other process mapping the same file; nothing is copied. */
+class MappedFile {
+public:
+    /* How the mapping will be read, passed on to madvise() */
+    enum class Access {
+        Normal,
+        Sequential,  // read once front to back, e.g. decoded and dropped
+        Random,      // looked up all over for a long time, e.g. fonts
+        WillNeed,    // read right away in full, prefetch it
+    };
+
+    MappedFile() = default;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile();
+
+    /* False when the file could not be opened, is empty or mapping failed */
+    bool valid() const { return m_data != nullptr; }
+    const uint8_t* data() const { return static_cast<const uint8_t*>(m_data); }
+    size_t size() const { return m_size; }
+    std::span<const uint8_t> bytes() const { return {data(), m_size}; }
+    std::string_view text() const { return {static_cast<const char*>(m_data), m_size}; }
+
+    void advise(Access access) const;
+
+private:
+    friend class File;
+    MappedFile(void* data, size_t size) : m_data(data), m_size(size) {}
+
+    void* m_data = nullptr;
+    size_t m_size = 0;
+};
+
 class File {
 public:
+    static MappedFile map(const std::string& path, MappedFile::Access access = MappedFile::Access::Normal);
+
+    /* Copies the file, prefer map() for anything but small files */
     static std::string read_all_text(const std::string& path);
 
     static std::vector<uint8_t> read_all_bytes(const std::string& path);
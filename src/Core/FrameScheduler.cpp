@@ -0,0 +1,190 @@
+#include "Core/FrameScheduler.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <format>
+
+#include "Core/Settings.hpp"
+#include "Debug/Logger.hpp"
+
+namespace Izo {
+
+// Covers the wake-up latency of the wait before a frame
+static constexpr auto kStartMargin = std::chrono::milliseconds(1);
+// Misses in a row before the adaptive cap halves the rate
+static constexpr int kMissesToThrottle = 3;
+// Frames with enough headroom before it goes back to the full rate
+static constexpr int kFastFramesToRecover = 60;
+
+static double to_ms(FrameScheduler::Clock::duration duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+FrameScheduler& FrameScheduler::the() {
+    static FrameScheduler g_instance;
+    return g_instance;
+}
+
+void FrameScheduler::set_refresh_period(Clock::duration period) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (period == Clock::duration::zero()) {
+        LogInfo("FrameScheduler: Refresh rate unknown, assuming 60 Hz");
+        return;
+    }
+    // Drivers without timings report nonsense, keep the 60 Hz default then
+    if (period < std::chrono::milliseconds(4) || period > std::chrono::milliseconds(50)) {
+        LogWarn("FrameScheduler: Ignoring refresh period of {} ms", to_ms(period));
+        return;
+    }
+    m_period = period;
+    LogInfo("FrameScheduler: Display refreshes at {} Hz", 1000.0 / to_ms(period));
+}
+
+FrameScheduler::Clock::duration FrameScheduler::interval() const {
+    int cap = Settings::frame_rate_cap.get();
+    if (cap <= 0) return m_period * m_adaptive_divisor;
+
+    // Whole vsyncs per frame, never faster than the cap
+    double refresh_hz = 1000.0 / to_ms(m_period);
+    int divisor = std::max(1, static_cast<int>(std::ceil(refresh_hz / cap - 0.01)));
+    return m_period * divisor;
+}
+
+FrameScheduler::Clock::duration FrameScheduler::work_estimate() const {
+    Clock::duration estimate = *std::max_element(m_recent_work.begin(), m_recent_work.end());
+    return std::min(estimate, interval());
+}
+
+FrameScheduler::Clock::time_point FrameScheduler::next_target(Clock::time_point now, Clock::duration margin) const {
+    auto slot_at_or_after = [this](Clock::time_point time) {
+        auto periods = (time - m_phase + m_period - Clock::duration(1)) / m_period;
+        return m_phase + periods * m_period;
+    };
+
+    Clock::time_point target = slot_at_or_after(now + work_estimate() + margin);
+    if (m_last_target != Clock::time_point{}) {
+        // Measured vsyncs jitter a little, half a period keeps the slot
+        target = std::max(target, slot_at_or_after(m_last_target + interval() - m_period / 2));
+    }
+    return target;
+}
+
+int FrameScheduler::ms_until_frame_start() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto now = Clock::now();
+    auto start = next_target(now, kStartMargin) - work_estimate() - kStartMargin;
+    if (start <= now) return 0;
+    return static_cast<int>(std::chrono::floor<std::chrono::milliseconds>(start - now).count());
+}
+
+FrameScheduler::FrameTiming FrameScheduler::begin_frame() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // The margin was spent on waking up, a frame starting a little late
+    // keeps the vsync it was planned for
+    FrameTiming frame;
+    frame.start = Clock::now();
+    frame.target = next_target(frame.start, Clock::duration::zero());
+    return frame;
+}
+
+void FrameScheduler::frame_recorded(const FrameTiming& frame) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // Passes that ended without damage leave the slot to the next frame
+    m_last_target = frame.target;
+}
+
+void FrameScheduler::frame_submitted(FrameTiming& frame) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    frame.submit = Clock::now();
+    Clock::duration work = frame.submit - frame.start;
+
+    m_recent_work[m_recent_index] = work;
+    m_recent_index = (m_recent_index + 1) % m_recent_work.size();
+
+    ++m_work_frames;
+    m_work_total += work;
+    m_work_max = std::max(m_work_max, work);
+}
+
+void FrameScheduler::frame_presented(const FrameTiming& frame, Clock::time_point vsync) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // Without vsync timestamps the frame is late if its work ran past the target
+    Clock::duration lateness;
+    bool missed;
+    if (vsync != Clock::time_point{}) {
+        m_phase = vsync;
+        lateness = vsync - frame.target;
+        missed = lateness > m_period / 2;
+    } else {
+        lateness = frame.submit - frame.target;
+        missed = lateness > Clock::duration::zero();
+    }
+
+    ++m_frames;
+    if (missed) {
+        ++m_missed;
+        m_worst_miss = std::max(m_worst_miss, lateness);
+        LogDebug("FrameScheduler: Frame missed its vsync by {} ms, work took {} ms",
+                 to_ms(lateness), to_ms(frame.submit - frame.start));
+    }
+    update_divisor(missed);
+}
+
+void FrameScheduler::frame_merged() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_frames;
+    ++m_missed;
+    update_divisor(true);
+}
+
+void FrameScheduler::update_divisor(bool missed) {
+    if (Settings::frame_rate_cap.get() > 0) {
+        m_adaptive_divisor = 1;
+        m_consecutive_misses = 0;
+        m_consecutive_fast = 0;
+        return;
+    }
+
+    if (missed) {
+        m_consecutive_fast = 0;
+        if (++m_consecutive_misses >= kMissesToThrottle && m_adaptive_divisor == 1) {
+            m_adaptive_divisor = 2;
+            LogInfo("FrameScheduler: Frames keep missing vsync, halving the frame rate");
+        }
+        return;
+    }
+
+    m_consecutive_misses = 0;
+    if (m_adaptive_divisor == 1) return;
+
+    // Recover once frames would fit into a single period with room to spare
+    if (work_estimate() + kStartMargin < m_period * 3 / 4) {
+        if (++m_consecutive_fast >= kFastFramesToRecover) {
+            m_adaptive_divisor = 1;
+            m_consecutive_fast = 0;
+            LogInfo("FrameScheduler: Back to the full frame rate");
+        }
+    } else {
+        m_consecutive_fast = 0;
+    }
+}
+
+std::vector<std::string> FrameScheduler::report() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    int cap = Settings::frame_rate_cap.get();
+    double refresh_hz = 1000.0 / to_ms(m_period);
+    double fps = 1000.0 / to_ms(interval());
+    double missed_percent = m_frames ? 100.0 * static_cast<double>(m_missed) / static_cast<double>(m_frames) : 0.0;
+    double work_avg = m_work_frames ? to_ms(m_work_total) / static_cast<double>(m_work_frames) : 0.0;
+
+    std::vector<std::string> lines;
+    lines.push_back(std::format("Refresh: {:.1f} Hz, cap: {}, pacing at {:.1f} fps",
+                                refresh_hz, cap > 0 ? std::to_string(cap) : std::string("adaptive"), fps));
+    lines.push_back(std::format("Frames: {}, missed: {} ({:.1f}%), worst miss: {:.2f} ms",
+                                m_frames, m_missed, missed_percent, to_ms(m_worst_miss)));
+    lines.push_back(std::format("Work: avg {:.2f} ms, max {:.2f} ms, estimate {:.2f} ms",
+                                work_avg, to_ms(m_work_max), to_ms(work_estimate())));
+    return lines;
+}
+
+}
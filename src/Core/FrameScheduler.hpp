@@ -0,0 +1,83 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Izo {
+
+/* Paces frames to the display. Each frame targets a vsync and starts as
+   late as the expected frame work allows, so input is sampled right before
+   rendering instead of right after the previous present. The rate is
+   capped by Settings::frame_rate_cap; 0 adapts, halving the rate while
+   frames keep missing their vsync. Frames start on the UI thread and are
+   submitted and presented on the render thread. */
+class FrameScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /* Travels with a frame from the UI to the render thread */
+    struct FrameTiming {
+        Clock::time_point start;
+        Clock::time_point target;
+        Clock::time_point submit;
+    };
+
+    static FrameScheduler& the();
+
+    void set_refresh_period(Clock::duration period);
+    Clock::duration refresh_period() const { return m_period; }
+
+    /* Milliseconds until the next frame should start, rounded down */
+    int ms_until_frame_start() const;
+
+    /* Plans the frame, it only takes its vsync once it was recorded */
+    FrameTiming begin_frame();
+    /* The frame has something to show and goes to the render thread */
+    void frame_recorded(const FrameTiming& frame);
+    /* Frame work is done, right before handing it to the display */
+    void frame_submitted(FrameTiming& frame);
+    /* vsync is when the frame went out, Clock::time_point{} if unknown */
+    void frame_presented(const FrameTiming& frame, Clock::time_point vsync);
+    /* The frame was folded into the next one before it was rendered */
+    void frame_merged();
+
+    std::vector<std::string> report() const;
+
+private:
+    FrameScheduler() = default;
+
+    Clock::time_point next_target(Clock::time_point now, Clock::duration margin) const;
+    Clock::duration interval() const;
+    Clock::duration work_estimate() const;
+    void update_divisor(bool missed);
+
+    Clock::duration m_period = std::chrono::nanoseconds(16666667);
+    // Any vsync, the others are whole periods away from it
+    Clock::time_point m_phase{};
+    int m_adaptive_divisor = 1;
+    int m_consecutive_misses = 0;
+    int m_consecutive_fast = 0;
+
+    // Work of the last frames, the estimate is their maximum so a single
+    // slow frame does not push the start time forward for long
+    std::array<Clock::duration, 8> m_recent_work{};
+    size_t m_recent_index = 0;
+
+    Clock::time_point m_last_target{};
+
+    uint64_t m_frames = 0;
+    uint64_t m_missed = 0;
+    // Merged frames count as frames but their work is never measured
+    uint64_t m_work_frames = 0;
+    Clock::duration m_work_total{};
+    Clock::duration m_work_max{};
+    Clock::duration m_worst_miss{};
+
+    mutable std::mutex m_mutex;
+};
+
+}
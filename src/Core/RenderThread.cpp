@@ -0,0 +1,134 @@
+#include "Core/RenderThread.hpp"
+
+#include <utility>
+
+#include "Core/Application.hpp"
+#include "Debug/BootProfiler.hpp"
+#include "Debug/Logger.hpp"
+#include "Graphics/Canvas.hpp"
+
+namespace Izo {
+
+void RecordedFrame::clear() {
+    commands.clear();
+    present_rects.clear();
+    heatmap_rects.clear();
+    show_overdraw = false;
+    timing = {};
+}
+
+RenderThread::RenderThread(Application& app, Painter& painter)
+    : m_app(app),
+      m_painter(painter),
+      m_direct_painter(std::make_unique<Canvas>(0, 0, nullptr)) {
+}
+
+RenderThread::~RenderThread() {
+    stop();
+}
+
+void RenderThread::start() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_running) return;
+    m_running = true;
+    m_thread = std::thread(&RenderThread::run_thread, this);
+    LogDebug("RenderThread: Started");
+}
+
+void RenderThread::stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_running) return;
+        m_running = false;
+    }
+    m_wake.notify_all();
+    if (m_thread.joinable()) m_thread.join();
+
+    // A frame that did not make it is dropped, wait_idle() must not hang on it
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pending.clear();
+        m_has_pending = false;
+    }
+    m_idle.notify_all();
+}
+
+void RenderThread::submit(RecordedFrame& frame) {
+    FrameScheduler::the().frame_recorded(frame.timing);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_has_pending) {
+            std::swap(m_pending, frame);
+            m_has_pending = true;
+        } else {
+            // The display fell behind, draw both frames in one go. The
+            // newer one decides the target vsync and debug overlays.
+            m_pending.commands.append(std::move(frame.commands));
+            m_pending.present_rects.insert(m_pending.present_rects.end(),
+                                           frame.present_rects.begin(), frame.present_rects.end());
+            m_pending.heatmap_rects.insert(m_pending.heatmap_rects.end(),
+                                           frame.heatmap_rects.begin(), frame.heatmap_rects.end());
+            m_pending.show_overdraw = frame.show_overdraw;
+            m_pending.timing = frame.timing;
+            FrameScheduler::the().frame_merged();
+        }
+    }
+    frame.clear();
+    m_wake.notify_one();
+}
+
+void RenderThread::wait_idle() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idle.wait(lock, [this] { return !m_has_pending && !m_busy; });
+}
+
+void RenderThread::run_thread() {
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this] { return !m_running || m_has_pending; });
+            if (!m_running) return;
+            std::swap(m_rendering, m_pending);
+            m_has_pending = false;
+            m_busy = true;
+        }
+
+        render(m_rendering);
+        m_rendering.clear();
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_busy = false;
+        }
+        m_idle.notify_all();
+    }
+}
+
+void RenderThread::render(RecordedFrame& frame) {
+    // Skips the copy from our canvas to the display where possible
+    Painter& painter = m_app.attach_back_buffer(*m_direct_painter.canvas()) ? m_direct_painter : m_painter;
+
+    painter.reset_clips_and_transform();
+    painter.set_overdraw_tracking(frame.show_overdraw);
+    painter.reset_overdraw();
+
+    frame.commands.replay(painter);
+
+    if (frame.show_overdraw) {
+        for (const auto& rect : frame.heatmap_rects) {
+            painter.draw_overdraw_heatmap(rect);
+        }
+    }
+
+    FrameScheduler::the().frame_submitted(frame.timing);
+    m_app.present(*painter.canvas(), frame.present_rects);
+    FrameScheduler::the().frame_presented(frame.timing, m_app.last_vsync());
+
+    // Boot ends once something is on screen, not when the frame was recorded
+    if (!m_presented_once) {
+        m_presented_once = true;
+        BootProfiler::the().mark_first_frame();
+    }
+}
+
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Core/FrameScheduler.hpp"
+#include "Geometry/Primitives.hpp"
+#include "Graphics/DisplayList.hpp"
+#include "Graphics/Painter.hpp"
+
+namespace Izo {
+
+class Application;
+
+/* Everything the render thread needs to put one frame on screen */
+struct RecordedFrame {
+    DisplayList commands;
+    std::vector<IntRect> present_rects;
+    // Dirty rects, the overdraw heatmap is drawn over them
+    std::vector<IntRect> heatmap_rects;
+    bool show_overdraw = false;
+    FrameScheduler::FrameTiming timing;
+
+    void clear();
+};
+
+/* Rasterizes and presents recorded frames while the UI thread goes on with
+   the next one. At most one frame waits while another renders; a frame
+   submitted before the waiting one was picked up is merged into it, so the
+   UI thread never blocks on rendering. */
+class RenderThread {
+public:
+    RenderThread(Application& app, Painter& painter);
+    ~RenderThread();
+
+    void start();
+    void stop();
+
+    /* Hands the frame over, frame is left empty for the next recording */
+    void submit(RecordedFrame& frame);
+    /* Blocks until every submitted frame was presented */
+    void wait_idle();
+
+private:
+    void run_thread();
+    void render(RecordedFrame& frame);
+
+    Application& m_app;
+    Painter& m_painter;
+    // Draws into the display's back buffer when the platform allows it
+    Painter m_direct_painter;
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_idle;
+    RecordedFrame m_pending;
+    RecordedFrame m_rendering;  // render thread only
+    bool m_presented_once = false;  // render thread only
+    bool m_has_pending = false;
+    bool m_busy = false;
+    bool m_running = false;
+    std::thread m_thread;
+};
+
+}
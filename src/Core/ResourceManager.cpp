@@ -1,9 +1,11 @@
 #include "Core/ResourceManager.hpp"
 #include "Core/File.hpp"
+#include "Core/ResourcePack.hpp"
 
 namespace Izo {
 
 std::string ResourceManagerBase::s_resource_root = "./res/";
+std::function<void()> ResourceManagerBase::s_reader_fence;
 
 std::string ResourceManagerBase::resource_root() {
     return s_resource_root;
@@ -20,7 +22,20 @@ void ResourceManagerBase::set_resource_root(const std::string& path) {
     }
 }
 
+void ResourceManagerBase::set_reader_fence(std::function<void()> fence) {
+    s_reader_fence = std::move(fence);
+}
+
+void ResourceManagerBase::wait_for_readers() {
+    if (s_reader_fence) s_reader_fence();
+}
+
 bool ResourceManagerBase::is_valid_resource_dir(const std::string &path) {
+    // A resource pack alone is enough, loose files are optional then
+    if (File::exists((std::filesystem::path(path) / ResourcePack::kFileName).string())) {
+        return true;
+    }
+
     // We check if the resource directory contains the following files
     // fonts, icons, theme
     std::vector<std::string> res_directories = {
@@ -1,13 +1,17 @@
 #pragma once
 
+#include <cstdint>
 #include <filesystem>
 #include <format>
+#include <functional>
 #include <map>
 #include <memory>
 #include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
+#include "Core/TaskPool.hpp"
 #include "Debug/Logger.hpp"
 
 namespace Izo {
@@ -22,80 +26,211 @@ class ResourceManagerBase {
     static void set_resource_root(const std::string& path);
     static bool is_valid_resource_dir(const std::string& path);
 
+    /* Resources are also read off the UI thread by the render thread. The
+       fence runs before a resource is freed or changed in place and blocks
+       until no recorded frame refers to resources anymore. */
+    static void set_reader_fence(std::function<void()> fence);
+    static void wait_for_readers();
+
    private:
     static std::string s_resource_root;
+    static std::function<void()> s_reader_fence;
 };
 
+/* Counted reference to a resource. Unlike a raw T*, it survives reloads and
+   reports nullptr instead of dangling once the resource was unloaded. */
+template <typename T>
+class ResourceHandle {
+   public:
+    ResourceHandle() = default;
+    ResourceHandle(const ResourceHandle& other) : m_index(other.m_index), m_generation(other.m_generation) { retain(); }
+    ResourceHandle(ResourceHandle&& other) noexcept : m_index(other.m_index), m_generation(other.m_generation) {
+        other.m_index = kInvalid;
+    }
+    ~ResourceHandle() { release(); }
+
+    ResourceHandle& operator=(ResourceHandle other) noexcept {
+        std::swap(m_index, other.m_index);
+        std::swap(m_generation, other.m_generation);
+        return *this;
+    }
+
+    T* get() const;
+    T* operator->() const { return get(); }
+    explicit operator bool() const { return get() != nullptr; }
+    bool operator==(const ResourceHandle& other) const = default;
+
+   private:
+    friend class ResourceManager<T>;
+    static constexpr uint32_t kInvalid = UINT32_MAX;
+
+    ResourceHandle(uint32_t index, uint32_t generation) : m_index(index), m_generation(generation) { retain(); }
+    void retain();
+    void release();
+
+    uint32_t m_index = kInvalid;
+    uint32_t m_generation = 0;
+};
+
+/* Memory a resource keeps alive, resources can report it via memory_bytes() */
+template <typename T>
+size_t resource_memory_bytes(const T& resource) {
+    if constexpr (requires { resource.memory_bytes(); }) {
+        return resource.memory_bytes();
+    } else {
+        return sizeof(T);
+    }
+}
+
+/* Owns every resource of one type. Only used from the UI thread, only the
+   construction of load_async() resources happens on workers.
+   Resources taken through the raw pointer API are pinned for the lifetime
+   of the app; resources only referenced by handles are evicted in LRU
+   order once the type exceeds its memory budget and reloaded on demand. */
 template <typename T>
 class ResourceManager : public ResourceManagerBase {
    public:
-    // Global Instance
+    using Handle = ResourceHandle<T>;
+    using ReadyCallback = std::function<void(T*)>;
+
+    struct Stats {
+        size_t loaded = 0;
+        size_t evicted = 0;
+        size_t bytes = 0;
+        size_t budget = 0;
+    };
+
+    // Global Instance, never destroyed so that handles released during
+    // static destruction still find it
     static ResourceManager& the() {
-        static ResourceManager s_instance;
-        return s_instance;
+        static ResourceManager* s_instance = new ResourceManager();
+        return *s_instance;
     }
 
     ~ResourceManager() = default;
 
     template <typename... Args>
     T* load(const std::string& name, const std::string& path, Args&&... args) {
-        std::filesystem::path root(resource_root());
-        std::filesystem::path full_path = root / path;
+        Slot* slot = load_slot(name, path, std::forward<Args>(args)...);
+        slot->pinned = true;
+        return slot->resource.get();
+    }
+
+    /* If T is loaded, returns T*, otherwise loads it and returns T* */
+    template <typename... Args>
+    T* get_or_load(const std::string& name, const std::string& path, Args&&... args) {
+        return load(name, path, std::forward<Args>(args)...);
+    }
 
-        auto it = resources.find(name);
-        if (it != resources.end())
-            return it->second.get();
+    /* If T is loaded, returns T*, otherwise nullopt */
+    T* get(const std::string& name) {
+        Slot* slot = find_slot(name);
+        if (!slot || !ensure_loaded(*slot)) return nullptr;
+        slot->pinned = true;
+        return slot->resource.get();
+    }
 
-        auto res = std::make_unique<T>(full_path.string(), std::forward<Args>(args)...);
+    /* T* if it is resident right now, nullptr otherwise. Neither loads nor
+       pins, for touching a resource only where it already is in memory */
+    T* find_loaded(const std::string& name) {
+        Slot* slot = find_slot(name);
+        if (!slot || slot->loading) return nullptr;
+        return slot->resource.get();
+    }
 
-        if (!res || !res->valid()) {
-            LogFatal("ResourceManager: Failed to load resource '{}' from '{}'", name, full_path.string());
+    T* get_or_crash(const std::string& name) {
+        T* resource = get(name);
+
+        if (!resource) {
+            LogFatal("Tried using unloaded resource: {}", name);
             // VERIFY_UNREACHED()
-            // Let's crash if the resource fails to load!
-            // TODO: Return std::expected<T, E> to allow caller to handle errors nicely
+            // LogFatal should terminate the app here
         }
 
-        auto res_ptr = res.get();
+        return resource;
+    }
 
-        resources.emplace(name, std::move(res));
+    /* Loads the resource if needed and returns an unpinned handle to it */
+    template <typename... Args>
+    Handle acquire_or_load(const std::string& name, const std::string& path, Args&&... args) {
+        Slot* slot = load_slot(name, path, std::forward<Args>(args)...);
+        return Handle(index_of(*slot), slot->generation);
+    }
 
-        return res_ptr;
+    /* Handle to an already registered resource, empty if unknown */
+    Handle acquire(const std::string& name) {
+        Slot* slot = find_slot(name);
+        if (!slot) return Handle();
+        if (!slot->loading && !ensure_loaded(*slot)) return Handle();
+        return Handle(index_of(*slot), slot->generation);
     }
 
-    /* If T is loaded, returns T*, otherwise loads it and returns T* */
-    template <typename... Args>
-    T* get_or_load(const std::string& name, const std::string& path, Args&&... args) {
-        auto it = resources.find(name);
-        if (it == resources.end()) {
-            return load(name, path, std::forward<Args>(args)...);
+    Handle acquire_or_crash(const std::string& name) {
+        Handle handle = acquire(name);
+
+        if (!handle) {
+            LogFatal("Tried using unloaded resource: {}", name);
         }
 
-        return it->second.get();
+        return handle;
     }
 
-    /* If T is loaded, returns T*, otherwise nullopt */
-    T* get(const std::string& name) const {
-        auto it = resources.find(name);
-        return (it != resources.end()) ? it->second.get() : nullptr;
-    }
+    /* Returns at once and constructs the resource on a TaskPool worker.
+       on_ready runs on the UI thread once it is in place (with nullptr if
+       loading failed); until then handles resolve to the placeholder. */
+    template <typename... Args>
+    Handle load_async(const std::string& name, const std::string& path, ReadyCallback on_ready, Args&&... args) {
+        Slot* slot = find_slot(name);
+        if (!slot) {
+            slot = &allocate_slot(name);
+            slot->path = path;
+            slot->loader = make_loader(path, std::forward<Args>(args)...);
+        }
 
-    T* get_or_crash(const std::string& name) const {
-        auto it = resources.find(name);
+        const uint32_t index = index_of(*slot);
+        const uint32_t generation = slot->generation;
+        if (slot->resource) {
+            if (on_ready) {
+                TaskPool::the().post_to_ui([on_ready, index, generation]() {
+                    on_ready(ResourceManager::the().resolve(index, generation));
+                });
+            }
+            return Handle(index, generation);
+        }
 
-        if (it == resources.end()) {
-            LogFatal("Tried using unloaded resource: {}", name);
-            // VERIFY_UNREACHED()
-            // LogFatal should terminate the app here
+        if (on_ready) slot->ready_callbacks.push_back(std::move(on_ready));
+        if (!slot->loading && slot->loader) {
+            slot->loading = true;
+            TaskPool::the().run_async([loader = slot->loader, index, generation]() {
+                auto resource = std::make_shared<std::unique_ptr<T>>(loader());
+                TaskPool::the().post_to_ui([resource, index, generation]() {
+                    ResourceManager::the().finish_async(index, generation, std::move(*resource));
+                });
+            });
         }
+        return Handle(index, generation);
+    }
 
-        return it->second.get();
+    /* Resolved by handles of resources that are still loading */
+    void set_placeholder(std::unique_ptr<T> resource) {
+        if (placeholder) wait_for_readers();
+        placeholder = std::move(resource);
     }
 
+    /* Replaces the resource in place, handles keep pointing at it. Raw
+       pointers to the old resource are invalidated. */
     template <typename... Args>
-    T* reload(const std::string& name, const std::string& path, Args&&... args)
+    Handle reload(const std::string& name, const std::string& path, Args&&... args)
     {
-        resources.erase(name);
-        return load(name, path, std::forward<Args>(args)...);
+        Slot* slot = find_slot(name);
+        if (!slot) return acquire_or_load(name, path, std::forward<Args>(args)...);
+
+        slot->path = path;
+        slot->loader = make_loader(path, std::forward<Args>(args)...);
+        wait_for_readers();
+        slot->resource.reset();
+        ensure_loaded(*slot);
+        return Handle(index_of(*slot), slot->generation);
     }
 
     T* reload_from_existing(const std::string& name, std::unique_ptr<T> res)
@@ -104,25 +239,238 @@ class ResourceManager : public ResourceManagerBase {
             LogError("Attempted to replace '{}' with an invalid resource", name);
             return nullptr;
         }
-        resources.erase(name);
-        T* ptr = res.get();
-        resources.emplace(name, std::move(res));
-        return ptr;
+        Slot* slot = find_slot(name);
+        if (!slot) slot = &allocate_slot(name);
+        if (slot->resource) wait_for_readers();
+        slot->resource = std::move(res);
+        slot->loader = nullptr;
+        slot->pinned = true;
+        slot->bytes = resource_memory_bytes(*slot->resource);
+        return slot->resource.get();
     }
 
+    /* Frees the resource, outstanding handles turn empty */
     void unload(const std::string& name) {
-        resources.erase(name);
+        auto it = names.find(name);
+        if (it == names.end()) return;
+
+        Slot& slot = slots[it->second];
+        if (slot.resource) wait_for_readers();
+        slot = Slot{.generation = slot.generation + 1};
+        free_slots.push_back(it->second);
+        names.erase(it);
     }
 
     void unload_all() {
-        resources.clear();
+        while (!names.empty()) {
+            unload(names.begin()->first);
+        }
+    }
+
+    /* Names of the resources loaded from path, relative to the resource root */
+    std::vector<std::string> names_for_path(const std::string& path) const {
+        std::vector<std::string> result;
+        for (const auto& [name, index] : names) {
+            if (slots[index].path == path) result.push_back(name);
+        }
+        return result;
+    }
+
+    /* Caps the memory of unpinned resources of this type, 0 = no limit */
+    void set_memory_budget(size_t bytes) {
+        budget = bytes;
+        enforce_budget();
+    }
+
+    Stats stats() {
+        Stats result;
+        result.budget = budget;
+        for (auto& slot : slots) {
+            if (!slot.resource) {
+                if (slot.loader) ++result.evicted;
+                continue;
+            }
+            // Images may have been reloaded in place, measure again
+            slot.bytes = resource_memory_bytes(*slot.resource);
+            result.bytes += slot.bytes;
+            ++result.loaded;
+        }
+        return result;
     }
 
    private:
+    friend class ResourceHandle<T>;
+
+    struct Slot {
+        std::unique_ptr<T> resource;
+        std::string name;
+        std::string path;
+        std::function<std::unique_ptr<T>()> loader;
+        std::vector<ReadyCallback> ready_callbacks;
+        uint32_t generation = 0;
+        uint32_t refcount = 0;
+        bool pinned = false;
+        bool loading = false;
+        size_t bytes = 0;
+        uint64_t last_used = 0;
+    };
+
     ResourceManager() = default;
     ResourceManager(const ResourceManager&) = delete;
     ResourceManager& operator=(const ResourceManager&) = delete;
-    std::map<std::string, std::unique_ptr<T>> resources;
+
+    template <typename... Args>
+    std::function<std::unique_ptr<T>()> make_loader(const std::string& path, Args&&... args) {
+        std::filesystem::path full_path = std::filesystem::path(resource_root()) / path;
+        return [full_path = full_path.string(), ... args = std::decay_t<Args>(std::forward<Args>(args))]() {
+            return std::make_unique<T>(full_path, args...);
+        };
+    }
+
+    template <typename... Args>
+    Slot* load_slot(const std::string& name, const std::string& path, Args&&... args) {
+        if (Slot* slot = find_slot(name)) {
+            ensure_loaded(*slot);
+            return slot;
+        }
+
+        Slot& slot = allocate_slot(name);
+        slot.path = path;
+        slot.loader = make_loader(path, std::forward<Args>(args)...);
+        ensure_loaded(slot);
+        return &slot;
+    }
+
+    Slot& allocate_slot(const std::string& name) {
+        uint32_t index;
+        if (!free_slots.empty()) {
+            index = free_slots.back();
+            free_slots.pop_back();
+        } else {
+            index = static_cast<uint32_t>(slots.size());
+            slots.emplace_back();
+        }
+        slots[index].name = name;
+        names.emplace(name, index);
+        return slots[index];
+    }
+
+    Slot* find_slot(const std::string& name) {
+        auto it = names.find(name);
+        return it != names.end() ? &slots[it->second] : nullptr;
+    }
+
+    uint32_t index_of(const Slot& slot) const { return static_cast<uint32_t>(&slot - slots.data()); }
+
+    /* Loads evicted or new resources through the slot's loader */
+    bool ensure_loaded(Slot& slot) {
+        slot.last_used = ++use_clock;
+        if (slot.resource) return true;
+        if (!slot.loader) return false;
+
+        auto res = slot.loader();
+
+        if (!res || !res->valid()) {
+            LogFatal("ResourceManager: Failed to load resource '{}' from '{}'", slot.name, slot.path);
+            // VERIFY_UNREACHED()
+            // Let's crash if the resource fails to load!
+        }
+
+        slot.resource = std::move(res);
+        slot.bytes = resource_memory_bytes(*slot.resource);
+        enforce_budget(&slot);
+        return slot.resource != nullptr;
+    }
+
+    /* Evicts unreferenced resources, least recently used first, except keep */
+    void enforce_budget(const Slot* keep = nullptr) {
+        if (budget == 0) return;
+
+        size_t total = 0;
+        for (const auto& slot : slots) {
+            if (slot.resource && !slot.pinned) total += slot.bytes;
+        }
+
+        while (total > budget) {
+            Slot* victim = nullptr;
+            for (auto& slot : slots) {
+                if (&slot == keep || !slot.resource || slot.pinned || slot.refcount > 0 || !slot.loader) continue;
+                if (!victim || slot.last_used < victim->last_used) victim = &slot;
+            }
+            if (!victim) break;
+
+            LogDebug("ResourceManager: Evicting '{}' ({} bytes)", victim->name, victim->bytes);
+            total -= victim->bytes;
+            wait_for_readers();
+            victim->resource.reset();
+        }
+    }
+
+    T* resolve(uint32_t index, uint32_t generation) {
+        if (index >= slots.size() || slots[index].generation != generation) return nullptr;
+        Slot& slot = slots[index];
+        slot.last_used = ++use_clock;
+        if (!slot.resource && slot.loading) return placeholder.get();
+        return slot.resource.get();
+    }
+
+    void finish_async(uint32_t index, uint32_t generation, std::unique_ptr<T> res) {
+        // Unloaded while the worker was busy
+        if (index >= slots.size() || slots[index].generation != generation) return;
+
+        Slot& slot = slots[index];
+        slot.loading = false;
+        // A synchronous get() may have loaded it in the meantime
+        if (!slot.resource) {
+            if (res && res->valid()) {
+                slot.resource = std::move(res);
+                slot.bytes = resource_memory_bytes(*slot.resource);
+                slot.last_used = ++use_clock;
+                enforce_budget(&slot);
+            } else {
+                LogError("ResourceManager: Failed to load resource '{}' from '{}'", slot.name, slot.path);
+            }
+        }
+
+        T* resource = slot.resource.get();
+        auto callbacks = std::move(slot.ready_callbacks);
+        for (auto& callback : callbacks) {
+            callback(resource);
+        }
+    }
+
+    void retain(uint32_t index, uint32_t generation) {
+        if (index < slots.size() && slots[index].generation == generation) ++slots[index].refcount;
+    }
+
+    void release(uint32_t index, uint32_t generation) {
+        if (index < slots.size() && slots[index].generation == generation && slots[index].refcount > 0)
+            --slots[index].refcount;
+    }
+
+    std::vector<Slot> slots;
+    std::vector<uint32_t> free_slots;
+    std::map<std::string, uint32_t> names;
+    size_t budget = 0;
+    uint64_t use_clock = 0;
+    std::unique_ptr<T> placeholder;
 };
 
+template <typename T>
+T* ResourceHandle<T>::get() const {
+    if (m_index == kInvalid) return nullptr;
+    return ResourceManager<T>::the().resolve(m_index, m_generation);
+}
+
+template <typename T>
+void ResourceHandle<T>::retain() {
+    if (m_index != kInvalid) ResourceManager<T>::the().retain(m_index, m_generation);
+}
+
+template <typename T>
+void ResourceHandle<T>::release() {
+    if (m_index != kInvalid) ResourceManager<T>::the().release(m_index, m_generation);
+    m_index = kInvalid;
+}
+
 }  // namespace Izo
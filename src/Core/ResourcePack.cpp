@@ -0,0 +1,235 @@
+#include "Core/ResourcePack.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+
+#include "Core/File.hpp"
+#include "Debug/Logger.hpp"
+#include "Lib/stb_image.h"
+
+namespace Izo {
+
+/* Pack layout, native endianness like the compiled themes:
+     PackHeader
+     Entry[entry_count]        (sorted by path)
+     char strings[string_bytes]
+     blobs, each starting at a multiple of kBlobAlignment */
+static constexpr char kPackMagic[4] = {'I', 'Z', 'P', 'K'};
+static constexpr uint32_t kPackVersion = 1;
+static constexpr uint64_t kBlobAlignment = 64;
+
+struct PackHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t entry_count;
+    uint32_t string_bytes;
+};
+
+enum class EntryKind : uint32_t {
+    Raw = 0,
+    Rgba8 = 1,
+};
+
+struct ResourcePack::Entry {
+    uint32_t path_offset, path_length;
+    uint64_t data_offset, data_size;
+    EntryKind kind;
+    uint32_t width, height;
+    uint32_t reserved;
+};
+
+static bool is_image(const std::filesystem::path& path) {
+    static constexpr const char* kExtensions[] = {".png", ".jpg", ".jpeg", ".bmp", ".tga"};
+    std::string extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    return std::find(std::begin(kExtensions), std::end(kExtensions), extension) != std::end(kExtensions);
+}
+
+ResourcePack& ResourcePack::the() {
+    static ResourcePack g_instance;
+    return g_instance;
+}
+
+bool ResourcePack::open(const std::string& path, const std::string& resource_root) {
+    if (is_open()) return true;
+
+    if (!File::exists(path)) return false;
+    // Entries are picked all over the file and only when a loader asks
+    MappedFile file = File::map(path, MappedFile::Access::Random);
+    if (file.size() < sizeof(PackHeader)) {
+        LogWarn("ResourcePack: Unable to map '{}'", path);
+        return false;
+    }
+
+    const size_t size = file.size();
+    const char* bytes = file.text().data();
+    PackHeader header;
+    std::memcpy(&header, bytes, sizeof(header));
+
+    const size_t entries_end = sizeof(PackHeader) + size_t(header.entry_count) * sizeof(Entry);
+    bool valid = std::memcmp(header.magic, kPackMagic, sizeof(kPackMagic)) == 0 &&
+                 header.version == kPackVersion &&
+                 entries_end + header.string_bytes <= size;
+
+    const auto* entries = reinterpret_cast<const Entry*>(bytes + sizeof(PackHeader));
+    for (size_t i = 0; valid && i < header.entry_count; ++i) {
+        const Entry& entry = entries[i];
+        valid = size_t(entry.path_offset) + entry.path_length <= header.string_bytes &&
+                entry.data_offset <= size && entry.data_size <= size - entry.data_offset &&
+                (entry.kind == EntryKind::Raw ||
+                 (entry.kind == EntryKind::Rgba8 && entry.data_size == uint64_t(entry.width) * entry.height * 4));
+    }
+    if (!valid) {
+        LogWarn("ResourcePack: '{}' is not a valid resource pack, using loose files", path);
+        return false;
+    }
+
+    m_file = std::move(file);
+    m_entries = entries;
+    m_entry_count = header.entry_count;
+    m_strings = bytes + entries_end;
+    m_root = resource_root;
+    m_overridden = std::make_unique<std::atomic<bool>[]>(m_entry_count);
+
+    LogInfo("ResourcePack: Serving {} files from '{}'", m_entry_count, path);
+    return true;
+}
+
+std::string_view ResourcePack::path_of(const Entry& entry) const {
+    return std::string_view(m_strings + entry.path_offset, entry.path_length);
+}
+
+const ResourcePack::Entry* ResourcePack::find_entry(std::string_view full_path) const {
+    if (!is_open() || !full_path.starts_with(m_root)) return nullptr;
+    std::string_view relative = full_path.substr(m_root.size());
+
+    const Entry* end = m_entries + m_entry_count;
+    const Entry* it = std::lower_bound(m_entries, end, relative, [this](const Entry& entry, std::string_view path) {
+        return path_of(entry) < path;
+    });
+    if (it == end || path_of(*it) != relative) return nullptr;
+    if (m_overridden[it - m_entries].load(std::memory_order_relaxed)) return nullptr;
+    return it;
+}
+
+std::span<const uint8_t> ResourcePack::find(std::string_view full_path) const {
+    const Entry* entry = find_entry(full_path);
+    if (!entry || entry->kind != EntryKind::Raw) return {};
+    return {m_file.data() + entry->data_offset, entry->data_size};
+}
+
+std::optional<ResourcePack::ImageData> ResourcePack::find_image(std::string_view full_path) const {
+    const Entry* entry = find_entry(full_path);
+    if (!entry || entry->kind != EntryKind::Rgba8) return std::nullopt;
+    return ImageData{
+        static_cast<int>(entry->width),
+        static_cast<int>(entry->height),
+        {m_file.data() + entry->data_offset, entry->data_size},
+    };
+}
+
+std::vector<std::string> ResourcePack::list(std::string_view directory) const {
+    std::vector<std::string> paths;
+    for (size_t i = 0; i < m_entry_count; ++i) {
+        std::string_view path = path_of(m_entries[i]);
+        if (path.size() > directory.size() + 1 && path.starts_with(directory) && path[directory.size()] == '/' &&
+            path.find('/', directory.size() + 1) == std::string_view::npos) {
+            paths.emplace_back(path);
+        }
+    }
+    return paths;
+}
+
+void ResourcePack::override_entry(std::string_view relative_path) {
+    if (!is_open()) return;
+    std::string full_path = m_root + std::string(relative_path);
+    if (const Entry* entry = find_entry(full_path)) {
+        m_overridden[entry - m_entries].store(true, std::memory_order_relaxed);
+        LogDebug("ResourcePack: '{}' changed on disk, using the loose file", relative_path);
+    }
+}
+
+bool ResourcePack::build(const std::string& resource_root, const std::string& output) {
+    namespace fs = std::filesystem;
+
+    struct Source {
+        std::string path;
+        fs::path full_path;
+    };
+    std::vector<Source> sources;
+
+    std::error_code ec;
+    for (auto it = fs::recursive_directory_iterator(resource_root, ec); !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+        if (!it->is_regular_file()) continue;
+        std::string relative = fs::relative(it->path(), resource_root).generic_string();
+        // Caches and earlier packs are regenerated, not shipped
+        if (relative == kFileName || relative.ends_with(".ini.bin") || relative.ends_with(".tmp")) continue;
+        sources.push_back({relative, it->path()});
+    }
+    if (ec) {
+        LogError("ResourcePack: Unable to scan '{}'", resource_root);
+        return false;
+    }
+    std::sort(sources.begin(), sources.end(), [](const Source& a, const Source& b) { return a.path < b.path; });
+
+    std::vector<Entry> entries(sources.size());
+    std::string strings;
+    for (size_t i = 0; i < sources.size(); ++i) {
+        entries[i].path_offset = static_cast<uint32_t>(strings.size());
+        entries[i].path_length = static_cast<uint32_t>(sources[i].path.size());
+        strings += sources[i].path;
+    }
+
+    std::vector<uint8_t> data(sizeof(PackHeader) + entries.size() * sizeof(Entry) + strings.size());
+    size_t image_count = 0;
+    for (size_t i = 0; i < sources.size(); ++i) {
+        data.resize((data.size() + kBlobAlignment - 1) / kBlobAlignment * kBlobAlignment);
+        Entry& entry = entries[i];
+        entry.data_offset = data.size();
+
+        int width = 0, height = 0, channels = 0;
+        unsigned char* pixels = nullptr;
+        if (is_image(sources[i].full_path)) {
+            pixels = stbi_load(sources[i].full_path.c_str(), &width, &height, &channels, 4);
+        }
+
+        if (pixels) {
+            entry.kind = EntryKind::Rgba8;
+            entry.width = static_cast<uint32_t>(width);
+            entry.height = static_cast<uint32_t>(height);
+            entry.data_size = uint64_t(width) * height * 4;
+            data.insert(data.end(), pixels, pixels + entry.data_size);
+            stbi_image_free(pixels);
+            ++image_count;
+        } else {
+            MappedFile file = File::map(sources[i].full_path.string(), MappedFile::Access::Sequential);
+            entry.kind = EntryKind::Raw;
+            entry.data_size = file.size();
+            data.insert(data.end(), file.data(), file.data() + file.size());
+        }
+    }
+
+    PackHeader header{};
+    std::memcpy(header.magic, kPackMagic, sizeof(kPackMagic));
+    header.version = kPackVersion;
+    header.entry_count = static_cast<uint32_t>(entries.size());
+    header.string_bytes = static_cast<uint32_t>(strings.size());
+
+    uint8_t* out = data.data();
+    std::memcpy(out, &header, sizeof(header));
+    std::memcpy(out + sizeof(header), entries.data(), entries.size() * sizeof(Entry));
+    std::memcpy(out + sizeof(header) + entries.size() * sizeof(Entry), strings.data(), strings.size());
+
+    std::string temp_path = output + ".tmp";
+    if (!File::write_all_bytes(temp_path, data) || !File::move(temp_path, output)) {
+        LogError("ResourcePack: Unable to write '{}'", output);
+        File::remove(temp_path);
+        return false;
+    }
+    LogInfo("ResourcePack: Packed {} files ({} images decoded) into '{}', {} bytes",
+            entries.size(), image_count, output, data.size());
+    return true;
+}
+
+}
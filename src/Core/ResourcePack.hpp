@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Core/File.hpp"
+
+namespace Izo {
+
+/* A single file holding the resource tree, built with --build-pack and
+   mapped once at boot. The header is followed by an index sorted by path,
+   the path strings and the file contents, each aligned so that entries can
+   be used in place. Images are stored decoded as RGBA8.
+
+   Lookups take full paths below the resource root, like the loaders do, and
+   are safe from any thread once open() returned. */
+class ResourcePack {
+public:
+    static constexpr const char* kFileName = "res.pack";
+
+    struct ImageData {
+        int width = 0;
+        int height = 0;
+        std::span<const uint8_t> pixels;
+    };
+
+    static ResourcePack& the();
+
+    /* Maps the pack at path, entries are matched against resource_root */
+    bool open(const std::string& path, const std::string& resource_root);
+    bool is_open() const { return m_file.valid(); }
+    size_t entry_count() const { return m_entry_count; }
+
+    /* Contents of the file at full_path, empty when it is not packed */
+    std::span<const uint8_t> find(std::string_view full_path) const;
+    /* Pre-decoded pixels of the image at full_path */
+    std::optional<ImageData> find_image(std::string_view full_path) const;
+    /* Paths relative to the resource root of the entries in directory */
+    std::vector<std::string> list(std::string_view directory) const;
+
+    /* Serves the loose file from now on, used when it changed on disk */
+    void override_entry(std::string_view relative_path);
+
+    /* Packs every file below resource_root into output */
+    static bool build(const std::string& resource_root, const std::string& output);
+
+private:
+    ResourcePack() = default;
+    ~ResourcePack() = default;
+
+    struct Entry;
+
+    const Entry* find_entry(std::string_view full_path) const;
+    std::string_view path_of(const Entry& entry) const;
+
+    MappedFile m_file;
+    const Entry* m_entries = nullptr;
+    size_t m_entry_count = 0;
+    const char* m_strings = nullptr;
+    std::string m_root;
+    std::unique_ptr<std::atomic<bool>[]> m_overridden;
+};
+
+}
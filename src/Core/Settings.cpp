@@ -4,12 +4,32 @@ namespace Izo {
 
 std::shared_ptr<Settings> Settings::instance = nullptr;
 
+SettingBase::SettingBase(const char* name) : m_name(name) {
+    Settings::setting_registry().push_back(this);
+}
+
+std::vector<SettingBase*>& Settings::setting_registry() {
+    static std::vector<SettingBase*> s_settings;
+    return s_settings;
+}
+
+const std::vector<SettingBase*>& Settings::typed_settings() {
+    return setting_registry();
+}
+
+SettingBase* Settings::find_setting(const std::string& key) {
+    for (SettingBase* setting : setting_registry()) {
+        if (key == setting->name()) return setting;
+    }
+    return nullptr;
+}
+
 Settings::Settings() 
     : data(std::make_unique<std::map<std::string, std::any>>()) {
 }
 
 bool Settings::has(const std::string& key) const {
-    return data->find(key) != data->end();
+    return find_setting(key) || data->find(key) != data->end();
 }
 
 void Settings::remove(const std::string& key) {
@@ -18,6 +38,9 @@ void Settings::remove(const std::string& key) {
 
 std::vector<std::string> Settings::keys() const {
     std::vector<std::string> result;
+    for (const SettingBase* setting : setting_registry()) {
+        result.push_back(setting->name());
+    }
     for (const auto& pair : *data) {
         result.push_back(pair.first);
     }
@@ -3,23 +3,151 @@
 #include <map>
 #include <string>
 #include <any>
+#include <atomic>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <type_traits>
 #include <vector>
 #include "Debug/Logger.hpp"
 
 namespace Izo {
 
+/* Untyped view of a TypedSetting, used by the string API of Settings */
+class SettingBase {
+public:
+    explicit SettingBase(const char* name);
+    virtual ~SettingBase() = default;
+
+    const char* name() const { return m_name; }
+
+    virtual std::any value_any() const = 0;
+    /* Returns false when value does not hold the setting's type */
+    virtual bool set_any(const std::any& value) = 0;
+
+    virtual std::string to_string() const = 0;
+    virtual bool set_from_string(const std::string& text) = 0;
+
+private:
+    const char* m_name;
+};
+
+/* A setting declared at compile time. Reads are a relaxed atomic load and
+   are safe from any thread; observers run on the thread calling set(). */
+template <typename T>
+    requires std::is_trivially_copyable_v<T>
+class TypedSetting final : public SettingBase {
+public:
+    using Observer = std::function<void(T)>;
+
+    TypedSetting(const char* name, T default_value) : SettingBase(name), m_value(default_value) {}
+
+    T get() const { return m_value.load(std::memory_order_relaxed); }
+
+    void set(T value) {
+        if (m_value.exchange(value, std::memory_order_relaxed) == value) return;
+
+        std::vector<Observer> observers;
+        {
+            std::lock_guard<std::mutex> lock(m_observers_mutex);
+            observers = m_observers;
+        }
+        for (const auto& observer : observers) {
+            observer(value);
+        }
+    }
+
+    void observe(Observer observer) {
+        std::lock_guard<std::mutex> lock(m_observers_mutex);
+        m_observers.push_back(std::move(observer));
+    }
+
+    std::any value_any() const override { return get(); }
+
+    bool set_any(const std::any& value) override {
+        const T* typed = std::any_cast<T>(&value);
+        if (!typed) return false;
+        set(*typed);
+        return true;
+    }
+
+    std::string to_string() const override {
+        if constexpr (std::is_same_v<T, bool>) {
+            return get() ? "true" : "false";
+        } else {
+            return std::to_string(get());
+        }
+    }
+
+    bool set_from_string(const std::string& text) override {
+        if constexpr (std::is_same_v<T, bool>) {
+            if (text == "true" || text == "on" || text == "1") { set(true); return true; }
+            if (text == "false" || text == "off" || text == "0") { set(false); return true; }
+            return false;
+        } else {
+            try {
+                size_t used = 0;
+                T value;
+                if constexpr (std::is_floating_point_v<T>) {
+                    value = static_cast<T>(std::stod(text, &used));
+                } else {
+                    value = static_cast<T>(std::stoll(text, &used));
+                }
+                if (used != text.size()) return false;
+                set(value);
+                return true;
+            } catch (...) {
+                return false;
+            }
+        }
+    }
+
+private:
+    std::atomic<T> m_value;
+    std::mutex m_observers_mutex;
+    std::vector<Observer> m_observers;
+};
+
 class Settings {
 public:
     Settings();
-    
+
+    /* Typed settings, read these directly on hot paths */
+    static inline TypedSetting<bool> debug{"debug", true};
+    static inline TypedSetting<bool> flash_dirty_regions{"flash-dirty-regions", false};
+    static inline TypedSetting<bool> overdraw_heatmap{"overdraw-heatmap", false};
+    /* Collapse runs of touch moves queued within one frame into the last one */
+    static inline TypedSetting<bool> coalesce_touch_moves{"coalesce-touch-moves", true};
+    /* Frames per second at most, 0 adapts to what the device keeps up with */
+    static inline TypedSetting<int> frame_rate_cap{"frame-rate-cap", 0};
+    /* fbdev: a third buffer, presenting only waits for the previous page
+       flip if it was queued less than a refresh period ago */
+    static inline TypedSetting<bool> triple_buffering{"triple-buffering", false};
+    /* fbdev: draw frames straight into the back buffer instead of copying
+       a canvas into it. Blending then reads framebuffer memory, which is
+       uncached on some devices. Read once when the display comes up. */
+    static inline TypedSetting<bool> zero_copy_present{"zero-copy-present", true};
+
     template<typename T>
     void set(const std::string& key, const T& value) {
+        if (SettingBase* setting = find_setting(key)) {
+            if (!setting->set_any(std::any(value))) {
+                LogWarn("Settings type mismatch for key: '{}'", key);
+            }
+            return;
+        }
         data->insert_or_assign(key, std::any(value));
     }
-    
+
     template<typename T>
     T get(const std::string& key) const {
+        if (SettingBase* setting = find_setting(key)) {
+            try {
+                return std::any_cast<T>(setting->value_any());
+            } catch (const std::bad_any_cast&) {
+                throw std::runtime_error("Settings type mismatch for key: " + key);
+            }
+        }
         try {
             return std::any_cast<T>(data->at(key));
         }
@@ -34,7 +162,7 @@ public:
     template<typename T>
     T get_or(const std::string& key, const T& default_val) const {
         try {
-            return std::any_cast<T>(data->at(key));
+            return get<T>(key);
         }
         catch (...) {
             LogWarn("Settings key not found: '{}', using default value: '{}'", key, default_val);
@@ -43,17 +171,24 @@ public:
     }
 
     bool has(const std::string& key) const;
-    
+
     void remove(const std::string& key);
-    
+
     std::vector<std::string> keys() const;
-    
+
+    /* Typed setting registered under key, or nullptr */
+    static SettingBase* find_setting(const std::string& key);
+    static const std::vector<SettingBase*>& typed_settings();
+
     static void init();
     static Settings& the();
 
 private:
+    friend class SettingBase;
+    static std::vector<SettingBase*>& setting_registry();
+
     std::unique_ptr<std::map<std::string, std::any>> data;
     static std::shared_ptr<Settings> instance;
 };
 
-} // namespace Izo
\ No newline at end of file
+} // namespace Izo
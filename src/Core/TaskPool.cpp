@@ -0,0 +1,84 @@
+#include "Core/TaskPool.hpp"
+
+#include <algorithm>
+
+#include "Core/Application.hpp"
+#include "Debug/Logger.hpp"
+
+namespace Izo {
+
+TaskPool& TaskPool::the() {
+    static TaskPool g_instance;
+    return g_instance;
+}
+
+TaskPool::TaskPool() {
+    // Leave a core for the UI thread, more workers only fight over storage
+    unsigned count = std::clamp(std::thread::hardware_concurrency(), 2u, 5u) - 1;
+    for (unsigned i = 0; i < count; ++i) {
+        m_workers.emplace_back(&TaskPool::run_worker, this);
+    }
+    LogDebug("TaskPool: Started {} workers", count);
+}
+
+TaskPool::~TaskPool() {
+    stop();
+}
+
+void TaskPool::stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_running) return;
+        m_running = false;
+    }
+    m_wake.notify_all();
+    for (auto& worker : m_workers) {
+        if (worker.joinable()) worker.join();
+    }
+}
+
+void TaskPool::run_async(Job job) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_running) return;
+        m_jobs.push_back(std::move(job));
+    }
+    m_wake.notify_one();
+}
+
+void TaskPool::post_to_ui(Job job) {
+    {
+        std::lock_guard<std::mutex> lock(m_ui_mutex);
+        m_ui_jobs.push_back(std::move(job));
+    }
+    Application::wake();
+}
+
+void TaskPool::dispatch_ui_jobs() {
+    std::vector<Job> jobs;
+    {
+        std::lock_guard<std::mutex> lock(m_ui_mutex);
+        if (m_ui_jobs.empty()) return;
+        jobs.swap(m_ui_jobs);
+    }
+
+    for (auto& job : jobs) {
+        job();
+    }
+}
+
+void TaskPool::run_worker() {
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this] { return !m_running || !m_jobs.empty(); });
+            if (!m_running) return;
+            job = std::move(m_jobs.front());
+            m_jobs.pop_front();
+        }
+        job();
+    }
+}
+
+}
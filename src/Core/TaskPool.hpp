@@ -0,0 +1,46 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Izo {
+
+/* Worker threads for blocking work (file I/O, decoding) plus the queue of
+   jobs that have to run back on the UI thread. */
+class TaskPool {
+public:
+    using Job = std::function<void()>;
+
+    static TaskPool& the();
+
+    /* Runs job on a worker thread */
+    void run_async(Job job);
+    /* Runs job on the UI thread during the next dispatch_ui_jobs() */
+    void post_to_ui(Job job);
+
+    /* Runs the jobs posted to the UI thread so far, call on the UI thread */
+    void dispatch_ui_jobs();
+
+    void stop();
+
+private:
+    TaskPool();
+    ~TaskPool();
+
+    void run_worker();
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::deque<Job> m_jobs;
+    bool m_running = true;
+    std::vector<std::thread> m_workers;
+
+    std::mutex m_ui_mutex;
+    std::vector<Job> m_ui_jobs;
+};
+
+}
@@ -8,7 +8,15 @@
 #include <format>
 #include <filesystem>
 #include <algorithm>
+#include <cstring>
+#include <istream>
+#include <streambuf>
+#include <cstdlib>
+#include <sys/stat.h>
+#include <unistd.h>
 #include "Core/ResourceManager.hpp"
+#include "Core/ResourcePack.hpp"
+#include "UI/Widgets/Toast.hpp"
 #include "UI/Widgets/Widget.hpp"
 
 
@@ -19,6 +27,74 @@ ThemeDB& ThemeDB::the() {
     return m_instance;
 }
 
+ThemeKey::ThemeKey(std::string_view section, std::string_view name)
+    : m_id(ThemeDB::the().intern(section, name)) {}
+
+uint32_t ThemeDB::intern(std::string_view section, std::string_view name) {
+    // Reused so that lookups of known keys do not allocate
+    static std::string s_lookup;
+    s_lookup.assign(section);
+    s_lookup.push_back('\n');
+    s_lookup.append(name);
+
+    auto it = m_key_ids.find(std::string_view(s_lookup));
+    if (it != m_key_ids.end()) return it->second;
+
+    uint32_t id = static_cast<uint32_t>(m_key_names.size());
+    m_key_names.push_back({std::string(section), std::string(name)});
+    m_key_ids.emplace(s_lookup, id);
+    m_values.emplace_back();
+    compile(id);
+    return id;
+}
+
+void ThemeDB::compile(uint32_t id) {
+    CompiledValue value;
+    const KeyName& key_name = m_key_names[id];
+
+    auto section_it = ini_file.find(key_name.section);
+    if (section_it != ini_file.end()) {
+        auto field_it = section_it->second.find(key_name.name);
+        if (field_it != section_it->second.end()) {
+            const ini::IniField& field = field_it->second;
+            value.present = true;
+            value.text = field.as<std::string>();
+
+            try { value.color = field.as<Color>(); value.has_color = true; } catch (...) {}
+            try { value.int_value = field.as<int>(); value.has_int = true; } catch (...) {}
+            try { value.float_value = field.as<float>(); value.has_float = true; } catch (...) {}
+            try { value.bool_value = field.as<bool>(); value.has_bool = true; } catch (...) {}
+        }
+    }
+
+    m_values[id] = std::move(value);
+}
+
+void ThemeDB::report_failure(uint32_t id, std::string_view type) const {
+    const CompiledValue& value = m_values[id];
+    value.reported = true;
+    while (!type.empty() && type.front() == ' ') type.remove_prefix(1);
+    m_failed_keys.push_back({id, type});
+
+    const KeyName& key_name = m_key_names[id];
+    if (!value.present) {
+        LogWarn("Failed to find theme key '{}/{}': Key not found!", key_name.section, key_name.name);
+    } else {
+        LogWarn("Failed to find theme key '{}/{}': Unable to parse key as {}!", key_name.section, key_name.name, type);
+    }
+}
+
+std::vector<std::string> ThemeDB::failed_keys() const {
+    std::vector<std::string> out;
+    out.reserve(m_failed_keys.size());
+    for (const FailedKey& failed : m_failed_keys) {
+        const KeyName& key_name = m_key_names[failed.id];
+        const char* reason = m_values[failed.id].present ? "unparsable as" : "missing, wanted";
+        out.push_back(std::format("{}/{} ({} {})", key_name.section, key_name.name, reason, failed.type));
+    }
+    return out;
+}
+
 static void list_theme_sections_and_values(ini::IniFile& ini_file) {
     LogDebug("File has {} sections", ini_file.size());
 
@@ -38,38 +114,299 @@ static void list_theme_sections_and_values(ini::IniFile& ini_file) {
 }
 
 
-bool ThemeDB::load(const std::string& path) {
-    std::filesystem::path root(ResourceManagerBase::resource_root());
-    std::filesystem::path relative(path);
-    std::string full_path = (root / relative).string();
+/* Compiled theme layout, native endianness since it never leaves the device:
+     CompiledHeader
+     CompiledEntry[entry_count]
+     char strings[string_bytes]  (section, name and raw text of every entry)
+   It is only used while the source .ini still has the recorded mtime and size. */
+static constexpr char kCompiledMagic[4] = {'I', 'Z', 'T', 'C'};
+static constexpr uint32_t kCompiledVersion = 1;
+static constexpr const char* kCompiledSuffix = ".bin";
 
-    std::string content = File::read_all_text(full_path);
+/* The resource directory may be read-only or shipped as is, so compiled
+   themes go to a per-user cache directory. Empty if there is none we can
+   write to, the theme is then parsed on every boot. */
+static std::string compiled_cache_path(const std::string& full_path) {
+    std::filesystem::path dir;
+#ifdef __ANDROID__
+    dir = "/data/local/tmp/izotrox";
+#else
+    if (const char* xdg = std::getenv("XDG_CACHE_HOME"); xdg && *xdg) {
+        dir = std::filesystem::path(xdg) / "izotrox";
+    } else if (const char* home = std::getenv("HOME"); home && *home) {
+        dir = std::filesystem::path(home) / ".cache" / "izotrox";
+    } else {
+        return {};
+    }
+#endif
+    File::create_directory(dir.string());
+    if (access(dir.c_str(), W_OK) != 0) return {};
+
+    // Themes from different resource roots must not share a file
+    std::error_code ec;
+    std::filesystem::path source = std::filesystem::absolute(full_path, ec);
+    size_t hash = std::hash<std::string>{}(ec ? full_path : source.string());
+    return (dir / std::format("{}-{:016x}{}", std::filesystem::path(full_path).filename().string(), hash,
+                              kCompiledSuffix)).string();
+}
+
+struct CompiledHeader {
+    char magic[4];
+    uint32_t version;
+    int64_t source_mtime_ns;
+    uint64_t source_size;
+    uint32_t entry_count;
+    uint32_t string_bytes;
+};
+
+struct CompiledEntry {
+    uint32_t section_offset, section_length;
+    uint32_t name_offset, name_length;
+    uint32_t text_offset, text_length;
+    uint8_t flags;
+    uint8_t bool_value;
+    uint8_t color[4];
+    uint8_t reserved[2];
+    int32_t int_value;
+    float float_value;
+};
+
+enum CompiledFlags : uint8_t {
+    HasColor = 1 << 0,
+    HasInt = 1 << 1,
+    HasFloat = 1 << 2,
+    HasBool = 1 << 3,
+};
+
+bool ThemeDB::load_compiled(const std::string& compiled_path, int64_t source_mtime_ns, uint64_t source_size) {
+    MappedFile file = File::map(compiled_path, MappedFile::Access::WillNeed);
+    if (file.size() < sizeof(CompiledHeader)) return false;
+
+    const size_t size = file.size();
+    const char* bytes = file.text().data();
+    CompiledHeader header;
+    std::memcpy(&header, bytes, sizeof(header));
+
+    const size_t entries_end = sizeof(CompiledHeader) + size_t(header.entry_count) * sizeof(CompiledEntry);
+    const bool valid = std::memcmp(header.magic, kCompiledMagic, sizeof(kCompiledMagic)) == 0 &&
+                       header.version == kCompiledVersion &&
+                       header.source_mtime_ns == source_mtime_ns &&
+                       header.source_size == source_size &&
+                       entries_end + header.string_bytes == size;
+    if (!valid) return false;
+
+    const char* strings = bytes + entries_end;
+    auto string_at = [&](uint32_t offset, uint32_t length, std::string_view& out) {
+        if (size_t(offset) + length > header.string_bytes) return false;
+        out = std::string_view(strings + offset, length);
+        return true;
+    };
+
+    std::vector<CompiledEntry> entries(header.entry_count);
+    std::memcpy(entries.data(), bytes + sizeof(CompiledHeader), entries.size() * sizeof(CompiledEntry));
+    for (const CompiledEntry& entry : entries) {
+        std::string_view section, name, text;
+        if (!string_at(entry.section_offset, entry.section_length, section) ||
+            !string_at(entry.name_offset, entry.name_length, name) ||
+            !string_at(entry.text_offset, entry.text_length, text)) {
+            return false;
+        }
+    }
+
+    // Validated, replace the current theme
+    ini_file.clear();
+    for (auto& value : m_values) {
+        value = CompiledValue{};
+    }
 
+    for (const CompiledEntry& entry : entries) {
+        std::string_view section, name, text;
+        string_at(entry.section_offset, entry.section_length, section);
+        string_at(entry.name_offset, entry.name_length, name);
+        string_at(entry.text_offset, entry.text_length, text);
+
+        CompiledValue& value = m_values[intern(section, name)];
+        value.present = true;
+        value.text.assign(text);
+        value.has_color = entry.flags & HasColor;
+        value.has_int = entry.flags & HasInt;
+        value.has_float = entry.flags & HasFloat;
+        value.has_bool = entry.flags & HasBool;
+        value.color = Color(entry.color[0], entry.color[1], entry.color[2], entry.color[3]);
+        value.int_value = entry.int_value;
+        value.float_value = entry.float_value;
+        value.bool_value = entry.bool_value != 0;
+    }
+
+    return true;
+}
+
+void ThemeDB::write_compiled(const std::string& compiled_path, int64_t source_mtime_ns, uint64_t source_size) const {
+    std::vector<CompiledEntry> entries;
+    std::string strings;
+    auto add_string = [&](std::string_view text, uint32_t& offset, uint32_t& length) {
+        offset = static_cast<uint32_t>(strings.size());
+        length = static_cast<uint32_t>(text.size());
+        strings.append(text);
+    };
+
+    for (const auto& [section_name, section] : ini_file) {
+        uint32_t section_offset, section_length;
+        add_string(section_name, section_offset, section_length);
+
+        for (const auto& [field_name, field] : section) {
+            auto id_it = m_key_ids.find(section_name + "\n" + field_name);
+            if (id_it == m_key_ids.end()) continue;
+            const CompiledValue& value = m_values[id_it->second];
+
+            CompiledEntry entry{};
+            entry.section_offset = section_offset;
+            entry.section_length = section_length;
+            add_string(field_name, entry.name_offset, entry.name_length);
+            add_string(value.text, entry.text_offset, entry.text_length);
+            entry.flags = (value.has_color ? HasColor : 0) | (value.has_int ? HasInt : 0) |
+                          (value.has_float ? HasFloat : 0) | (value.has_bool ? HasBool : 0);
+            entry.bool_value = value.bool_value;
+            entry.color[0] = value.color.r;
+            entry.color[1] = value.color.g;
+            entry.color[2] = value.color.b;
+            entry.color[3] = value.color.a;
+            entry.int_value = value.int_value;
+            entry.float_value = value.float_value;
+            entries.push_back(entry);
+        }
+    }
+
+    CompiledHeader header{};
+    std::memcpy(header.magic, kCompiledMagic, sizeof(kCompiledMagic));
+    header.version = kCompiledVersion;
+    header.source_mtime_ns = source_mtime_ns;
+    header.source_size = source_size;
+    header.entry_count = static_cast<uint32_t>(entries.size());
+    header.string_bytes = static_cast<uint32_t>(strings.size());
+
+    std::vector<uint8_t> data(sizeof(header) + entries.size() * sizeof(CompiledEntry) + strings.size());
+    std::memcpy(data.data(), &header, sizeof(header));
+    std::memcpy(data.data() + sizeof(header), entries.data(), entries.size() * sizeof(CompiledEntry));
+    std::memcpy(data.data() + sizeof(header) + entries.size() * sizeof(CompiledEntry), strings.data(), strings.size());
+
+    // Renamed into place so a concurrent boot never maps a partial file
+    std::string temp_path = compiled_path + ".tmp";
+    if (!File::write_all_bytes(temp_path, data) || !File::move(temp_path, compiled_path)) {
+        LogDebug("Unable to write compiled theme '{}'", compiled_path);
+        File::remove(temp_path);
+        return;
+    }
+    LogDebug("Wrote compiled theme '{}' ({} keys)", compiled_path, entries.size());
+}
+
+/* Lets the ini parser read mapped text without copying it into a string */
+struct TextViewBuffer : std::streambuf {
+    explicit TextViewBuffer(std::string_view text) {
+        char* begin = const_cast<char*>(text.data());
+        setg(begin, begin, begin + text.size());
+    }
+};
+
+bool ThemeDB::load_ini(const std::string& full_path, std::string_view content) {
     if (content.empty()) {
         LogError("Failed to load theme from '{}': Empty file!", full_path);
         return false;
     }
 
-    ini_file.decode(content);
+    TextViewBuffer buffer(content);
+    std::istream stream(&buffer);
+    ini_file.clear();
+    ini_file.decode(stream);
 
     list_theme_sections_and_values(ini_file);
 
+    // Intern every key of the file and decode all known keys up front
+    for (const auto& [section_name, section] : ini_file) {
+        for (const auto& [field_name, field] : section) {
+            intern(section_name, field_name);
+        }
+    }
+    for (uint32_t id = 0; id < m_key_names.size(); ++id) {
+        compile(id);
+    }
+    return true;
+}
+
+bool ThemeDB::load(const std::string& path) {
+    std::filesystem::path root(ResourceManagerBase::resource_root());
+    std::filesystem::path relative(path);
+    std::string full_path = (root / relative).string();
+
+    std::vector<CompiledValue> previous = m_values;
+
+    // A loose theme wins over the resource pack, its compiled cache is
+    // mapped as well and it is the copy the theme editor writes to
+    struct stat st;
+    if (stat(full_path.c_str(), &st) == 0) {
+        const int64_t mtime_ns = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+        const uint64_t source_size = static_cast<uint64_t>(st.st_size);
+        const std::string compiled_path = compiled_cache_path(full_path);
+
+        if (compiled_path.empty() || !load_compiled(compiled_path, mtime_ns, source_size)) {
+            MappedFile file = File::map(full_path, MappedFile::Access::Sequential);
+            if (!load_ini(full_path, file.text())) return false;
+            if (!compiled_path.empty()) write_compiled(compiled_path, mtime_ns, source_size);
+        }
+    } else {
+        auto packed = ResourcePack::the().find(full_path);
+        if (packed.empty()) {
+            LogError("Failed to load theme from '{}': File not found!", full_path);
+            return false;
+        }
+        if (!load_ini(full_path, std::string_view(reinterpret_cast<const char*>(packed.data()), packed.size()))) return false;
+    }
+    m_failed_keys.clear();
+
+    // Keys first interned by this load were never read, so only keys known
+    // before can have readers that need to be told about a change
+    bool any_changed = false;
+    m_changed_keys.assign(m_values.size(), false);
+    for (uint32_t id = 0; id < previous.size(); ++id) {
+        const CompiledValue& before = previous[id];
+        const CompiledValue& after = m_values[id];
+        if (before.present != after.present || before.text != after.text) {
+            m_changed_keys[id] = true;
+            any_changed = true;
+        }
+    }
+
     LogInfo("Successfully loaded theme from {}!", path);
     LogInfo("Theme Details:");
     LogInfo("  Name: {}", get<std::string>("ThemeManifest", "Name", "Unknown"));
     LogInfo("  Author: {}", get<std::string>("ThemeManifest", "Author", "Unknown"));
     LogInfo("  Version: {}", get<std::string>("ThemeManifest", "Version", "0.0.0"));
 
-    auto fontFamily = ThemeDB::the().get<std::string>("System", "FontFamily", "fonts/Roboto-Regular.ttf");
-    auto fontSize = ThemeDB::the().get<float>("System", "FontSize", 32.0);
-    FontManager::the().reload("system-ui", fontFamily, fontSize);
-    Widget::notify_theme_update_all();
-    ViewManager::the().invalidate_full();
+    static const ThemeKey k_font_family{"System", "FontFamily"};
+    static const ThemeKey k_font_size{"System", "FontSize"};
+    if (!FontManager::the().acquire("system-ui") || key_changed(k_font_family.id()) || key_changed(k_font_size.id())) {
+        reload_fonts();
+    } else if (any_changed) {
+        Widget::notify_theme_keys_changed();
+        // Keys read while drawing are not tracked, repaint everything
+        ViewManager::the().invalidate_full();
+    }
 
     current_path = path;
     return true;
 }
 
+void ThemeDB::reload_fonts() {
+    static const ThemeKey k_font_family{"System", "FontFamily"};
+    static const ThemeKey k_font_size{"System", "FontSize"};
+    auto fontFamily = get<std::string>(k_font_family, "fonts/Roboto-Regular.ttf");
+    auto fontSize = get<float>(k_font_size, 32.0);
+    // Widget handles follow the reload, but their cached metrics need a refresh
+    ToastManager::the().set_font(FontManager::the().reload("system-ui", fontFamily, fontSize));
+    Widget::notify_theme_update_all();
+    ViewManager::the().invalidate_full();
+}
+
 bool ThemeDB::reload() {
     if (current_path.empty()) return false;
     return load(current_path);
@@ -80,7 +417,11 @@ std::vector<std::string> ThemeDB::theme_names(const std::string& directory) cons
     std::filesystem::path relative(directory);
     std::string full_path = (root / relative).string();
 
-    if (!File::exists(full_path) || !File::is_directory(full_path)) {
+    auto entries = ResourcePack::the().list(directory);
+    if (File::is_directory(full_path)) {
+        auto loose = File::list_directory(full_path);
+        entries.insert(entries.end(), loose.begin(), loose.end());
+    } else if (entries.empty()) {
         LogWarn("Theme directory not found: '{}'", full_path);
         return {};
     }
@@ -95,7 +436,6 @@ std::vector<std::string> ThemeDB::theme_names(const std::string& directory) cons
         names.push_back(name);
     };
 
-    auto entries = File::list_directory(full_path);
     for (const auto& entry : entries) {
         if (File::is_directory(entry)) continue;
         if (File::get_extension(entry) != ".ini") continue;
@@ -111,21 +451,30 @@ std::vector<std::string> ThemeDB::theme_names(const std::string& directory) cons
 }
 
 Color ThemeDB::get_variant_color(ColorVariant variant) {
-    std::string key = "Default";
+    static const ThemeKey k_default{"ColorVariants", "Default"};
+    static const ThemeKey k_primary{"ColorVariants", "Primary"};
+    static const ThemeKey k_secondary{"ColorVariants", "Secondary"};
+    static const ThemeKey k_tertiary{"ColorVariants", "Tertiary"};
+    static const ThemeKey k_success{"ColorVariants", "Success"};
+    static const ThemeKey k_warning{"ColorVariants", "Warning"};
+    static const ThemeKey k_error{"ColorVariants", "Error"};
+    static const ThemeKey k_info{"ColorVariants", "Info"};
+    static const ThemeKey k_muted{"ColorVariants", "Muted"};
 
+    const ThemeKey* key = &k_default;
     switch (variant) {
-        case ColorVariant::Default: key = "Default"; break;
-        case ColorVariant::Primary: key = "Primary"; break;
-        case ColorVariant::Secondary: key = "Secondary"; break;
-        case ColorVariant::Tertiary: key = "Tertiary"; break;
-        case ColorVariant::Success: key = "Success"; break;
-        case ColorVariant::Warning: key = "Warning"; break;
-        case ColorVariant::Error: key = "Error"; break;
-        case ColorVariant::Info: key = "Info"; break;
-        case ColorVariant::Muted: key = "Muted"; break;
-    }
-
-    return get<Color>("ColorVariants", key, Color::White);
+        case ColorVariant::Default: key = &k_default; break;
+        case ColorVariant::Primary: key = &k_primary; break;
+        case ColorVariant::Secondary: key = &k_secondary; break;
+        case ColorVariant::Tertiary: key = &k_tertiary; break;
+        case ColorVariant::Success: key = &k_success; break;
+        case ColorVariant::Warning: key = &k_warning; break;
+        case ColorVariant::Error: key = &k_error; break;
+        case ColorVariant::Info: key = &k_info; break;
+        case ColorVariant::Muted: key = &k_muted; break;
+    }
+
+    return get<Color>(*key, Color::White);
 }
 
 }
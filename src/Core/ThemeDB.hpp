@@ -6,47 +6,151 @@
 #include "Graphics/ColorVariant.hpp"
 #include "Lib/inicpp.hpp"
 #include "Lib/magic_enum.hpp"
+#include <cstdint>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
 namespace Izo {
 
+/* Interned theme key, resolve it once and every lookup is an index into the
+   compiled theme table:
+     static const ThemeKey k_bg{"Colors", "Window.Background"};
+     ThemeDB::the().get<Color>(k_bg, Color(0)); */
+class ThemeKey {
+public:
+    ThemeKey(std::string_view section, std::string_view name);
+    uint32_t id() const { return m_id; }
+
+private:
+    uint32_t m_id;
+};
+
 class ThemeDB {
 public:
     static ThemeDB& the();
 
     bool load(const std::string& path);
     bool reload();
+    /* Reloads the system font from the theme, refreshing every widget */
+    void reload_fonts();
+    const std::string& path() const { return current_path; }
     Color get_variant_color(ColorVariant variant);
     std::vector<std::string> theme_names(const std::string& directory = "themes") const;
 
     template <typename T>
     T get(const std::string& section, const std::string& name, T default_val) const
     {
-        auto fail = [&](const std::string& reason) -> T {
-            LogWarn("Failed to find theme key '{}/{}': {}", section, name, reason);
-            return default_val;
-        };
+        return get<T>(ThemeKey(section, name), default_val);
+    }
 
-        auto section_it = ini_file.find(section);
-        if (section_it == ini_file.end()) 
-            return fail("Key not found!");
+    template <typename T>
+    T get(const ThemeKey& key, T default_val) const
+    {
+        if (m_read_log) m_read_log->push_back(key.id());
 
-        auto key_it = section_it->second.find(name);
-        if (key_it == section_it->second.end()) 
-            return fail("Key not found!");
+        const CompiledValue& value = m_values[key.id()];
+        // Only the first failure per key and theme load is reported
+        auto fail = [&]() -> T {
+            if (!value.reported) report_failure(key.id(), type_name<T>());
+            return default_val;
+        };
 
-        try {
-            return key_it->second.template as<T>();
-        } catch (...) {
-            return fail(std::format("Unable to parse key as {}!", type_name<T>()));
+        if (!value.present)
+            return fail();
+
+        if constexpr (std::is_same_v<T, Color>) {
+            if (value.has_color) return value.color;
+        } else if constexpr (std::is_same_v<T, int>) {
+            if (value.has_int) return value.int_value;
+        } else if constexpr (std::is_same_v<T, float>) {
+            if (value.has_float) return value.float_value;
+        } else if constexpr (std::is_same_v<T, bool>) {
+            if (value.has_bool) return value.bool_value;
+        } else if constexpr (std::is_same_v<T, std::string>) {
+            return value.text;
+        } else if constexpr (std::is_enum_v<T>) {
+            // Resolved by name once per key and enum type
+            if (value.enum_tag == &s_enum_tag<T>) return static_cast<T>(value.enum_value);
+            if (auto parsed = magic_enum::enum_cast<T>(std::string_view(value.text))) {
+                value.enum_tag = &s_enum_tag<T>;
+                value.enum_value = static_cast<int64_t>(*parsed);
+                return *parsed;
+            }
+        } else {
+            try {
+                return ini::IniField(value.text).template as<T>();
+            } catch (...) {
+            }
         }
+
+        return fail();
     }
 
+    /* Returns the handle of section/name, compiling it on first use */
+    uint32_t intern(std::string_view section, std::string_view name);
+
+    /* Keys that were missing or failed to parse since the last theme load */
+    std::vector<std::string> failed_keys() const;
+
+    /* Whether the value of the key differs from the previously loaded theme */
+    bool key_changed(uint32_t id) const { return id < m_changed_keys.size() && m_changed_keys[id]; }
+    /* While set, the id of every key looked up is appended to log */
+    void set_read_log(std::vector<uint32_t>* log) { m_read_log = log; }
 
 private:
+    struct KeyName {
+        std::string section;
+        std::string name;
+    };
+
+    /* A theme value decoded once at load time into every type it parses as */
+    struct CompiledValue {
+        bool present = false;
+        mutable bool reported = false;
+        bool has_color = false;
+        bool has_int = false;
+        bool has_float = false;
+        bool has_bool = false;
+        Color color;
+        int int_value = 0;
+        float float_value = 0.0f;
+        bool bool_value = false;
+        std::string text;
+        mutable const void* enum_tag = nullptr;
+        mutable int64_t enum_value = 0;
+    };
+
+    template <typename T>
+    static constexpr char s_enum_tag = 0;
+
+    struct KeyHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view key) const { return std::hash<std::string_view>{}(key); }
+    };
+
+    struct FailedKey {
+        uint32_t id;
+        std::string_view type;
+    };
+
+    void compile(uint32_t id);
+    bool load_ini(const std::string& full_path, std::string_view content);
+    /* Binary theme kept in the user's cache directory, see ThemeDB.cpp for the layout */
+    bool load_compiled(const std::string& compiled_path, int64_t source_mtime_ns, uint64_t source_size);
+    void write_compiled(const std::string& compiled_path, int64_t source_mtime_ns, uint64_t source_size) const;
+    void report_failure(uint32_t id, std::string_view type) const;
+
     std::string current_path;
     ini::IniFile ini_file;
+
+    std::vector<KeyName> m_key_names;
+    std::unordered_map<std::string, uint32_t, KeyHash, std::equal_to<>> m_key_ids;
+    std::vector<CompiledValue> m_values;
+    mutable std::vector<FailedKey> m_failed_keys;
+    std::vector<bool> m_changed_keys;
+    std::vector<uint32_t>* m_read_log = nullptr;
 };
 
 } 
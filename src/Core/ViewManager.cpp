@@ -72,6 +72,55 @@ void ViewManager::invalidate_rect(const IntRect& rect) {
 void ViewManager::invalidate_full() {
     m_full_redraw_needed = true;
     m_dirty_rects.clear();
+    m_scroll_blits.clear();
+}
+
+bool ViewManager::scroll_rect(const Widget* widget, const IntRect& rect, int dy) {
+    if (m_full_redraw_needed) return true;
+    if (m_width <= 0 || m_height <= 0) return false;
+
+    // Moving pixels is only valid if nothing else is drawn over the widget
+    if (m_animating || m_dialog || m_stack.empty() || Application::the().debug_mode()) return false;
+
+    const Widget* root = widget;
+    while (root->parent()) root = root->parent();
+    if (root != m_stack.back()->root()) return false;
+
+    IntRect area = clip_to_screen(rect, m_width, m_height);
+    if (area.w <= 0 || area.h <= std::abs(dy)) return false;
+    if (m_scroll_blits.size() >= 8) return false;
+
+    // Damage registered earlier this frame travels with the pixels
+    std::vector<IntRect> moved;
+    for (const auto& dirty : m_dirty_rects) {
+        IntRect part = dirty.intersection(area);
+        if (part.w <= 0 || part.h <= 0) continue;
+        part.y += dy;
+        moved.push_back(part.intersection(area));
+    }
+
+    m_scroll_blits.push_back({area, dy});
+    for (const auto& part : moved) {
+        invalidate_rect(part);
+    }
+
+    if (dy < 0) {
+        invalidate_rect({area.x, area.bottom() + dy, area.w, -dy});
+    } else {
+        invalidate_rect({area.x, area.y, area.w, dy});
+    }
+    return true;
+}
+
+bool ViewManager::is_opaque_in(const IntRect& rect) const {
+    if (m_animating || m_stack.empty()) return false;
+    return m_stack.back()->is_opaque_in(rect);
+}
+
+std::vector<ScrollBlit> ViewManager::consume_scroll_blits() {
+    std::vector<ScrollBlit> blits = std::move(m_scroll_blits);
+    m_scroll_blits.clear();
+    return blits;
 }
 
 bool ViewManager::has_dirty() const {
@@ -81,6 +130,7 @@ bool ViewManager::has_dirty() const {
 std::vector<IntRect> ViewManager::consume_dirty_rects() {
     if (m_width <= 0 || m_height <= 0) {
         m_dirty_rects.clear();
+        m_scroll_blits.clear();
         m_full_redraw_needed = false;
         return {};
     }
@@ -98,6 +148,7 @@ std::vector<IntRect> ViewManager::consume_dirty_rects() {
 
 bool ViewManager::needs_redraw() const {
     if (has_dirty()) return true;
+    if (ms_until_scheduled_update() == 0) return true;
     if (m_animating) return true;
     if (m_dialog && (m_dialog->m_dialog_anim.running() || m_dialog->has_running_animations())) return true;
     if (!m_stack.empty() && m_stack.back() && m_stack.back()->has_running_animations()) return true;
@@ -234,7 +285,24 @@ void ViewManager::resize(int w, int h) {
     invalidate_full();
 }
 
+void ViewManager::schedule_update(float delay_ms) {
+    auto deadline = std::chrono::steady_clock::now() +
+                    std::chrono::microseconds(static_cast<long long>(std::max(0.0f, delay_ms) * 1000.0f));
+    if (!m_scheduled_update || deadline < *m_scheduled_update) {
+        m_scheduled_update = deadline;
+    }
+}
+
+int ViewManager::ms_until_scheduled_update() const {
+    if (!m_scheduled_update) return -1;
+    auto remaining = *m_scheduled_update - std::chrono::steady_clock::now();
+    if (remaining <= std::chrono::steady_clock::duration::zero()) return 0;
+    // Rounded up, waking a little early would only spin
+    return static_cast<int>(std::chrono::ceil<std::chrono::milliseconds>(remaining).count());
+}
+
 void ViewManager::update() {
+    m_scheduled_update.reset();
     int scroll = Input::the().scroll_y();
 
     if (m_dialog) {
@@ -288,7 +356,8 @@ void ViewManager::update() {
 void ViewManager::draw(Painter& painter) {
     if (m_stack.empty()) return;
 
-    Color color_win_bg = ThemeDB::the().get<Color>("Colors", "Window.Background", Color(0));
+    static const ThemeKey k_window_bg{"Colors", "Window.Background"};
+    Color color_win_bg = ThemeDB::the().get<Color>(k_window_bg, Color(0));
 
     if (m_animating) {
         float t = m_transition_anim.value();
@@ -6,6 +6,8 @@
 #include "UI/View/View.hpp"
 #include "Graphics/Dialog.hpp"
 
+#include <chrono>
+#include <optional>
 #include <vector>
 #include <memory>
 #include <deque>
@@ -14,6 +16,7 @@
 namespace Izo {
 
 class Painter;
+class Widget;
 class View;
 class Dialog;
 
@@ -29,6 +32,12 @@ enum class ViewTransition {
 };
 
 
+/* Already rendered pixels of rect that have to be moved by dy before repainting */
+struct ScrollBlit {
+    IntRect rect;
+    int dy;
+};
+
 class ViewManager {
 public:
     ViewManager(const ViewManager&) = delete;
@@ -55,8 +64,20 @@ public:
     void invalidate_full();
     bool has_dirty() const;
     std::vector<IntRect> consume_dirty_rects();
+    /* Scrolls the rendered pixels of rect instead of repainting them. Returns
+       false if that is not safe right now and the caller has to invalidate. */
+    bool scroll_rect(const Widget* widget, const IntRect& rect, int dy);
+    std::vector<ScrollBlit> consume_scroll_blits();
     bool needs_redraw() const;
 
+    /* Asks for an update() in delay_ms even if nothing else happens, e.g. for
+       the next cursor blink. Requests last until the next update(). */
+    void schedule_update(float delay_ms);
+    /* Milliseconds until the earliest scheduled update, -1 if there is none */
+    int ms_until_scheduled_update() const;
+    /* Whether the views fully cover rect, so no window background is needed below */
+    bool is_opaque_in(const IntRect& rect) const;
+
     bool is_animating() const { return m_animating; }
     size_t stack_size() const { return m_stack.size(); }
 
@@ -91,7 +112,9 @@ private:
     bool m_processing_operation = false;
 
     std::vector<IntRect> m_dirty_rects;
+    std::vector<ScrollBlit> m_scroll_blits;
     bool m_full_redraw_needed = true;
+    std::optional<std::chrono::steady_clock::time_point> m_scheduled_update;
 
     int m_width = 0;
     int m_height = 0;
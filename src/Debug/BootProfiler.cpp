@@ -0,0 +1,107 @@
+#include "Debug/BootProfiler.hpp"
+
+#include <algorithm>
+#include <ctime>
+#include <format>
+
+#include "Debug/Logger.hpp"
+
+namespace Izo {
+
+static int64_t cpu_clock_us(clockid_t clock) {
+    timespec ts{};
+    clock_gettime(clock, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+}
+
+BootProfiler& BootProfiler::the() {
+    static BootProfiler g_instance;
+    return g_instance;
+}
+
+BootProfiler::BootProfiler()
+    : m_origin(std::chrono::steady_clock::now()), m_ui_thread(std::this_thread::get_id()) {}
+
+int64_t BootProfiler::now_us() const {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_origin).count();
+}
+
+int64_t BootProfiler::thread_cpu_us() {
+    return cpu_clock_us(CLOCK_THREAD_CPUTIME_ID);
+}
+
+BootProfiler::Phase::Phase(std::string name)
+    : m_name(std::move(name)), m_start_us(BootProfiler::the().now_us()), m_cpu_start_us(thread_cpu_us()) {}
+
+BootProfiler::Phase::~Phase() {
+    BootProfiler& profiler = BootProfiler::the();
+    profiler.add({
+        std::move(m_name),
+        m_start_us,
+        profiler.now_us() - m_start_us,
+        thread_cpu_us() - m_cpu_start_us,
+        std::this_thread::get_id() == profiler.m_ui_thread,
+    });
+}
+
+void BootProfiler::add(Record record) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_records.push_back(std::move(record));
+}
+
+void BootProfiler::set_critical_path(std::vector<std::string> names, int64_t wall_us) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_critical_path = std::move(names);
+    m_critical_path_us = wall_us;
+}
+
+void BootProfiler::mark_first_frame() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_first_frame_us >= 0) return;
+        m_first_frame_us = now_us();
+        m_first_frame_cpu_us = cpu_clock_us(CLOCK_PROCESS_CPUTIME_ID);
+    }
+
+    for (const auto& line : report()) {
+        LogInfo("{}", line);
+    }
+}
+
+bool BootProfiler::finished() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_first_frame_us >= 0;
+}
+
+std::vector<std::string> BootProfiler::report() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<std::string> lines;
+    if (m_first_frame_us < 0) {
+        lines.push_back("Boot report: first frame not presented yet");
+        return lines;
+    }
+
+    auto ms = [](int64_t us) { return us / 1000.0; };
+    lines.push_back(std::format("Boot report: first frame after {:.1f} ms, {:.1f} ms CPU in all threads",
+                                ms(m_first_frame_us), ms(m_first_frame_cpu_us)));
+    lines.push_back(std::format("  {:<28} {:>8} {:>8} {:>8}  {}", "phase", "start", "wall", "cpu", "thread"));
+
+    auto records = m_records;
+    std::sort(records.begin(), records.end(), [](const Record& a, const Record& b) { return a.start_us < b.start_us; });
+    for (const auto& record : records) {
+        lines.push_back(std::format("  {:<28} {:>8.1f} {:>8.1f} {:>8.1f}  {}", record.name, ms(record.start_us),
+                                    ms(record.wall_us), ms(record.cpu_us), record.ui_thread ? "ui" : "worker"));
+    }
+
+    if (!m_critical_path.empty()) {
+        std::string path;
+        for (const auto& name : m_critical_path) {
+            if (!path.empty()) path += " > ";
+            path += name;
+        }
+        lines.push_back(std::format("  critical path ({:.1f} ms): {}", ms(m_critical_path_us), path));
+    }
+    return lines;
+}
+
+}
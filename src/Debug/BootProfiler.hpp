@@ -0,0 +1,66 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Izo {
+
+/* Wall and CPU time of every boot phase, relative to the construction of
+   the profiler at the top of main(). The report is logged once the first
+   frame was presented and is kept for the `boot` shell command. */
+class BootProfiler {
+public:
+    static BootProfiler& the();
+
+    /* Times its own scope on the calling thread */
+    class Phase {
+    public:
+        explicit Phase(std::string name);
+        ~Phase();
+        Phase(const Phase&) = delete;
+        Phase& operator=(const Phase&) = delete;
+
+    private:
+        std::string m_name;
+        int64_t m_start_us;
+        int64_t m_cpu_start_us;
+    };
+
+    /* Longest dependency chain of the boot graph, in order */
+    void set_critical_path(std::vector<std::string> names, int64_t wall_us);
+    void mark_first_frame();
+
+    bool finished() const;
+    std::vector<std::string> report() const;
+
+private:
+    BootProfiler();
+
+    struct Record {
+        std::string name;
+        int64_t start_us;
+        int64_t wall_us;
+        int64_t cpu_us;
+        bool ui_thread;
+    };
+
+    int64_t now_us() const;
+    static int64_t thread_cpu_us();
+    void add(Record record);
+
+    std::chrono::steady_clock::time_point m_origin;
+    std::thread::id m_ui_thread;
+
+    mutable std::mutex m_mutex;
+    std::vector<Record> m_records;
+    std::vector<std::string> m_critical_path;
+    int64_t m_critical_path_us = 0;
+    int64_t m_first_frame_us = -1;
+    int64_t m_first_frame_cpu_us = 0;
+};
+
+}
@@ -1,11 +1,16 @@
 #include "IzoShell.hpp"
 #include "Core/ThemeDB.hpp"
 #include "Core/Application.hpp"
+#include "Core/Settings.hpp"
 #include "Core/ViewManager.hpp"
+#include "Core/FrameScheduler.hpp"
+#include "Debug/BootProfiler.hpp"
 #include "Debug/Logger.hpp"
 #include "UI/Widgets/Toast.hpp"
 #include "Core/ResourceManager.hpp"
 #include "Core/File.hpp"
+#include "Graphics/Font.hpp"
+#include "Graphics/Image.hpp"
 #include "Views/LauncherView.hpp"
 
 #include <sstream>
@@ -53,10 +58,10 @@ void IzoShell::register_all_commands() {
             return out;
         });
 
-    register_command("theme", "Theme management", "theme <load|list|reload> [name]",
+    register_command("theme", "Theme management", "theme <load|list|reload|missing> [name]",
         [](const std::vector<std::string>& args) {
             if (args.size() < 2) {
-                throw std::runtime_error("Usage: theme <load|list|reload> [name]");
+                throw std::runtime_error("Usage: theme <load|list|reload|missing> [name]");
             }
 
             std::string subcmd = args[1];
@@ -107,6 +112,19 @@ void IzoShell::register_all_commands() {
                 } else {
                     throw std::runtime_error("Failed to reload theme");
                 }
+            } else if (subcmd == "missing") {
+                std::vector<std::string> keys = ThemeDB::the().failed_keys();
+                if (keys.empty()) {
+                    return std::string("No missing theme keys");
+                }
+                std::stringstream out;
+                out << "Missing theme keys:";
+                for (const auto& key : keys) {
+                    out << "\n  " << key;
+                }
+                std::string out_str = out.str();
+                LogInfo("\n{}", out_str);
+                return out_str;
             } else {
                 throw std::runtime_error("Unknown theme subcommand: " + subcmd);
             }
@@ -143,6 +161,118 @@ void IzoShell::register_all_commands() {
             return out;
         });
 
+    register_command("setting", "Show or change typed settings", "setting [name] [value]",
+        [](const std::vector<std::string>& args) {
+            if (args.size() == 1) {
+                std::stringstream out;
+                out << "Settings:";
+                for (const SettingBase* setting : Settings::typed_settings()) {
+                    out << "\n  " << setting->name() << " = " << setting->to_string();
+                }
+                std::string out_str = out.str();
+                LogInfo("\n{}", out_str);
+                return out_str;
+            }
+
+            SettingBase* setting = Settings::find_setting(args[1]);
+            if (!setting) {
+                throw std::runtime_error("Unknown setting: " + args[1]);
+            }
+            if (args.size() > 2 && !setting->set_from_string(args[2])) {
+                throw std::runtime_error("Invalid value for " + args[1] + ": " + args[2]);
+            }
+
+            std::string out = std::string(setting->name()) + " = " + setting->to_string();
+            LogInfo("{}", out);
+            return out;
+        });
+
+    register_command("loglevel", "Show or change runtime log levels", "loglevel [subsystem|all] [level]",
+        [](const std::vector<std::string>& args) {
+            static constexpr const char* level_names[] = {"trace", "debug", "info", "warn", "error", "fatal"};
+            constexpr int subsystem_count = static_cast<int>(LogSubsystem::Count);
+
+            auto to_lower = [](std::string text) {
+                std::transform(text.begin(), text.end(), text.begin(), ::tolower);
+                return text;
+            };
+
+            if (args.size() == 3) {
+                std::string level_arg = to_lower(args[2]);
+                int level = -1;
+                for (int i = 0; i < 6; ++i) {
+                    if (level_arg == level_names[i]) level = i;
+                }
+                if (level < 0) {
+                    throw std::runtime_error("Unknown log level: " + args[2]);
+                }
+
+                std::string target = to_lower(args[1]);
+                bool matched = false;
+                for (int i = 0; i < subsystem_count; ++i) {
+                    auto subsystem = static_cast<LogSubsystem>(i);
+                    if (target == "all" || target == to_lower(Logger::subsystem_name(subsystem))) {
+                        Logger::the().set_level(subsystem, static_cast<LogLevel>(level));
+                        matched = true;
+                    }
+                }
+                if (!matched) {
+                    throw std::runtime_error("Unknown subsystem: " + args[1]);
+                }
+            } else if (args.size() != 1) {
+                throw std::runtime_error("Usage: loglevel [subsystem|all] [level]");
+            }
+
+            std::stringstream out;
+            out << "Log levels:";
+            for (int i = 0; i < subsystem_count; ++i) {
+                auto subsystem = static_cast<LogSubsystem>(i);
+                out << "\n  " << Logger::subsystem_name(subsystem) << " = "
+                    << level_names[static_cast<int>(Logger::the().level(subsystem))];
+            }
+            std::string out_str = out.str();
+            LogInfo("\n{}", out_str);
+            return out_str;
+        });
+
+    register_command("resources", "Show resource memory usage", "resources",
+        [](const std::vector<std::string>&) {
+            auto describe = [](const char* type, const auto& stats) {
+                std::string budget = stats.budget ? std::format("{} KiB", stats.budget / 1024) : "unlimited";
+                return std::format("\n  {}: {} loaded, {} evicted, {} KiB (budget {})",
+                                   type, stats.loaded, stats.evicted, stats.bytes / 1024, budget);
+            };
+
+            std::string out = "Resources:";
+            out += describe("Images", ImageManager::the().stats());
+            // Fonts are pinned by the widgets holding them, there is no budget
+            out += describe("Fonts", FontManager::the().stats());
+            LogInfo("\n{}", out);
+            return out;
+        });
+
+    register_command("boot", "Show the boot report", "boot",
+        [](const std::vector<std::string>&) {
+            std::string out;
+            for (const auto& line : BootProfiler::the().report()) {
+                if (!out.empty()) out += "\n";
+                out += line;
+            }
+            LogInfo("\n{}", out);
+            return out;
+        });
+
+    register_command("frames", "Show frame pacing and missed deadlines", "frames",
+        [](const std::vector<std::string>&) {
+            std::string out;
+            for (const auto& line : FrameScheduler::the().report()) {
+                if (!out.empty()) out += "\n";
+                out += line;
+            }
+            LogInfo("\n{}", out);
+            return out;
+        });
+
     register_command("exit", "Exit the application", "exit",
         [](const std::vector<std::string>&) {
             std::string out = "Exiting application...";
@@ -179,13 +309,13 @@ void IzoShell::register_all_commands() {
             std::transform(subcmd.begin(), subcmd.end(), subcmd.begin(), ::tolower);
 
             if (subcmd == "on") {
-                Application::the().set_debug(true);
+                Settings::debug.set(true);
                 std::string out = "Debug mode enabled";
                 LogInfo("{}", out);
                 ToastManager::the().show(out);
                 return out;
             } else if (subcmd == "off") {
-                Application::the().set_debug(false);
+                Settings::debug.set(false);
                 std::string out = "Debug mode disabled";
                 LogInfo("{}", out);
                 ToastManager::the().show(out);
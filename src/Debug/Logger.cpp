@@ -1,4 +1,7 @@
 #include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <iomanip>
 #include <iostream>
 #include <sstream>
 #include <fstream>
@@ -28,19 +31,45 @@ static const char *color_for_level(LogLevel lvl) {
   }
 }
 
-static std::string timestamp() {
+// Set on the writer thread, it cannot wait for itself to drain its own ring
+static thread_local bool t_is_writer = false;
+
+// Log timestamps are taken from the monotonic clock and mapped onto the wall
+// clock of the first log call
+struct ClockOrigin {
+  std::chrono::steady_clock::time_point steady = std::chrono::steady_clock::now();
+  std::chrono::system_clock::time_point wall = std::chrono::system_clock::now();
+};
+
+static const ClockOrigin& clock_origin() {
+  static const ClockOrigin s_origin;
+  return s_origin;
+}
+
+static int64_t monotonic_ns() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - clock_origin().steady).count();
+}
+
+static void append_timestamp(std::string &out, int64_t timestamp_ns) {
   using namespace std::chrono;
-  auto now = system_clock::now();
-  auto itt = system_clock::to_time_t(now);
-  auto ms = duration_cast<milliseconds>(now.time_since_epoch()) % 1000;
+  auto wall = clock_origin().wall + duration_cast<system_clock::duration>(nanoseconds(timestamp_ns));
+  auto itt = system_clock::to_time_t(wall);
+  auto ms = duration_cast<milliseconds>(wall.time_since_epoch()).count() % 1000;
 
-  std::ostringstream ss;
-  ss << std::put_time(std::localtime(&itt), "%Y-%m-%d %H:%M:%S") << '.'
-     << std::setfill('0') << std::setw(3) << ms.count();
-  return ss.str();
+  // Callers of drain() hold m_write_mutex, so the per-second part can be cached
+  static time_t s_cached_second = -1;
+  static char s_cached_text[32];
+  if (itt != s_cached_second) {
+    std::tm tm;
+    localtime_r(&itt, &tm);
+    std::strftime(s_cached_text, sizeof(s_cached_text), "%Y-%m-%d %H:%M:%S", &tm);
+    s_cached_second = itt;
+  }
+  std::format_to(std::back_inserter(out), "{}.{:03}", s_cached_text, ms);
 }
 
-static std::string level_to_string(LogLevel lvl) {
+static const char *level_to_string(LogLevel lvl) {
   switch (lvl) {
     case LogLevel::Trace: return "TRACE";
     case LogLevel::Debug: return "DEBUG";
@@ -52,28 +81,60 @@ static std::string level_to_string(LogLevel lvl) {
   }
 }
 
-static std::string format_as_log(LogLevel lvl, const std::string &msg) {
-  std::ostringstream oss;
-  oss << ConsoleColor::BrightCyan << "Izotrox> " << ConsoleColor::Reset << "["
-      << timestamp() << "]"
-      << "(" << level_to_string(lvl) << ") " << color_for_level(lvl) << msg
-      << ConsoleColor::Reset;
-  return oss.str();
+static void append_log_line(std::string &out, LogLevel lvl, int64_t timestamp_ns, std::string_view msg) {
+  out += ConsoleColor::BrightCyan;
+  out += "Izotrox> ";
+  out += ConsoleColor::Reset;
+  out += '[';
+  append_timestamp(out, timestamp_ns);
+  out += "](";
+  out += level_to_string(lvl);
+  out += ") ";
+  out += color_for_level(lvl);
+  out += msg;
+  out += ConsoleColor::Reset;
+  out += '\n';
 }
 
-static std::string format_as_log_no_color(LogLevel lvl, const std::string &msg) {
-  std::ostringstream oss;
-  oss << "Izotrox> [" << timestamp() << "]"
-      << "(" << level_to_string(lvl) << ") " << msg;
-  return oss.str();
+static void append_log_line_no_color(std::string &out, LogLevel lvl, int64_t timestamp_ns, std::string_view msg) {
+  out += "Izotrox> [";
+  append_timestamp(out, timestamp_ns);
+  out += "](";
+  out += level_to_string(lvl);
+  out += ") ";
+  out += msg;
+  out += '\n';
+}
+
+/* Single producer (the owning thread), single consumer (whoever holds
+   m_write_mutex). Entries keep their string capacity between uses. */
+struct Logger::Ring {
+  static constexpr size_t kCapacity = 512;
+
+  struct Entry {
+    LogLevel level = LogLevel::Info;
+    int64_t timestamp_ns = 0;
+    std::string text;
+  };
+
+  Entry entries[kCapacity];
+  std::atomic<size_t> head{0};  // Next slot to write, owned by the producer
+  std::atomic<size_t> tail{0};  // Next slot to read, owned by the consumer
+  std::atomic<uint64_t> dropped{0};
+};
+
+Logger::Logger() {
+  m_writer_thread = std::thread(&Logger::run_writer, this);
+  // The instance is never destroyed so that late log calls stay valid,
+  // stop the writer and write out what is left at exit instead
+  std::atexit([] { Logger::the().shutdown(); });
 }
 
-Logger::Logger(){}
 Logger::~Logger() = default;
 
 Logger &Logger::the() {
-  static Logger s_instance;
-  return s_instance;
+  static Logger* s_instance = new Logger();
+  return *s_instance;
 }
 
 void Logger::enable_logging_to_file() {
@@ -121,12 +182,275 @@ void Logger::enable_logging_to_file() {
     }
 }
 
+void Logger::set_level(LogSubsystem subsystem, LogLevel level) {
+  m_levels[static_cast<int>(subsystem)].store(static_cast<int>(level), std::memory_order_relaxed);
+}
+
+LogLevel Logger::level(LogSubsystem subsystem) const {
+  return static_cast<LogLevel>(m_levels[static_cast<int>(subsystem)].load(std::memory_order_relaxed));
+}
+
+const char* Logger::subsystem_name(LogSubsystem subsystem) {
+  switch (subsystem) {
+    case LogSubsystem::Core:     return "Core";
+    case LogSubsystem::Debug:    return "Debug";
+    case LogSubsystem::Geometry: return "Geometry";
+    case LogSubsystem::Graphics: return "Graphics";
+    case LogSubsystem::HAL:      return "HAL";
+    case LogSubsystem::Input:    return "Input";
+    case LogSubsystem::Motion:   return "Motion";
+    case LogSubsystem::Platform: return "Platform";
+    case LogSubsystem::UI:       return "UI";
+    case LogSubsystem::Views:    return "Views";
+    default:                     return "Other";
+  }
+}
+
+bool Logger::within_rate_limit(LogSite& site) {
+  uint32_t limit = m_rate_limit.load(std::memory_order_relaxed);
+  if (limit == 0) return true;
+
+  // Races between threads only blur the window edge, which is fine here
+  int64_t now_ms = monotonic_ns() / 1000000;
+  int64_t window_start = site.window_start_ms.load(std::memory_order_relaxed);
+  if (now_ms - window_start >= 1000) {
+    site.window_start_ms.store(now_ms, std::memory_order_relaxed);
+    site.count.store(0, std::memory_order_relaxed);
+    uint32_t suppressed = site.suppressed.exchange(0, std::memory_order_relaxed);
+    if (suppressed > 0) {
+      log(LogLevel::Warn, std::format("Suppressed {} messages from {}:{}", suppressed, site.file, site.line));
+    }
+  }
+
+  if (site.count.fetch_add(1, std::memory_order_relaxed) < limit) return true;
+  if (site.suppressed.fetch_add(1, std::memory_order_relaxed) == 0) {
+    // The site may not log again, the writer reports it once the window ends
+    std::lock_guard<std::mutex> lock(m_suppressed_mutex);
+    if (std::find(m_suppressed_sites.begin(), m_suppressed_sites.end(), &site) == m_suppressed_sites.end()) {
+      m_suppressed_sites.push_back(&site);
+    }
+  }
+  return false;
+}
+
+int64_t Logger::report_suppressed(bool all) {
+  std::vector<std::pair<LogSite*, uint32_t>> due;
+  int64_t next_due_ms = -1;
+  {
+    std::lock_guard<std::mutex> lock(m_suppressed_mutex);
+    int64_t now_ms = monotonic_ns() / 1000000;
+    std::erase_if(m_suppressed_sites, [&](LogSite* site) {
+      int64_t left_ms = site->window_start_ms.load(std::memory_order_relaxed) + 1000 - now_ms;
+      if (!all && left_ms > 0) {
+        next_due_ms = next_due_ms < 0 ? left_ms : std::min(next_due_ms, left_ms);
+        return false;
+      }
+      // Zero if the site logged again and reported it itself
+      uint32_t suppressed = site->suppressed.exchange(0, std::memory_order_relaxed);
+      if (suppressed > 0) due.emplace_back(site, suppressed);
+      return true;
+    });
+  }
+
+  for (const auto& [site, suppressed] : due) {
+    log(LogLevel::Warn, std::format("Suppressed {} messages from {}:{}", suppressed, site->file, site->line));
+  }
+  return next_due_ms;
+}
+
 void Logger::log(LogLevel lvl, const std::string &msg) {
-  std::lock_guard<std::mutex> lock(m_log_mutex);
-  std::cout << format_as_log(lvl, msg) << std::endl;
+  if (std::string* text = begin_entry(lvl)) {
+    text->append(msg);
+    commit_entry();
+  }
+}
+
+Logger::Ring* Logger::thread_ring() {
+  // Rings of exited threads are kept, there are only a few long-lived threads
+  thread_local Ring* t_ring = nullptr;
+  if (!t_ring) {
+    auto ring = std::make_unique<Ring>();
+    t_ring = ring.get();
+    std::lock_guard<std::mutex> lock(m_rings_mutex);
+    m_rings.push_back(std::move(ring));
+  }
+  return t_ring;
+}
+
+std::string* Logger::begin_entry(LogLevel lvl) {
+  Ring* ring = thread_ring();
+  size_t head = ring->head.load(std::memory_order_relaxed);
+
+  while (head - ring->tail.load(std::memory_order_acquire) >= Ring::kCapacity) {
+    bool must_keep = m_overflow_policy.load(std::memory_order_relaxed) == LogOverflowPolicy::Block || lvl >= LogLevel::Warn;
+    if (!must_keep) {
+      ring->dropped.fetch_add(1, std::memory_order_relaxed);
+      return nullptr;
+    }
+
+    if (!m_running || t_is_writer) {
+      std::lock_guard<std::mutex> lock(m_write_mutex);
+      drain();
+    } else {
+      m_wake.notify_one();
+      std::this_thread::yield();
+    }
+  }
+
+  Ring::Entry& entry = ring->entries[head % Ring::kCapacity];
+  entry.level = lvl;
+  entry.timestamp_ns = monotonic_ns();
+  entry.text.clear();
+  return &entry.text;
+}
+
+void Logger::commit_entry() {
+  Ring* ring = thread_ring();
+  size_t head = ring->head.load(std::memory_order_relaxed) + 1;
+  ring->head.store(head, std::memory_order_release);
+
+  if (!m_running) {
+    // Writer is gone (exiting), write synchronously
+    std::lock_guard<std::mutex> lock(m_write_mutex);
+    drain();
+    return;
+  }
+
+  // Pairs with the fence in run_writer(): either the writer sees this entry
+  // before it goes to sleep or we see it idle. Only the first entry after
+  // that wakes it, later ones are batched with it.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (m_writer_idle.load(std::memory_order_relaxed) && m_writer_idle.exchange(false)) {
+    std::lock_guard<std::mutex> lock(m_wake_mutex);
+    m_wake.notify_one();
+  }
+}
+
+bool Logger::has_pending_entries() {
+  std::lock_guard<std::mutex> lock(m_rings_mutex);
+  for (const auto& ring : m_rings) {
+    if (ring->head.load(std::memory_order_relaxed) != ring->tail.load(std::memory_order_relaxed)) return true;
+  }
+  return false;
+}
+
+void Logger::flush() {
+  report_suppressed(true);
+  std::lock_guard<std::mutex> lock(m_write_mutex);
+  drain();
+}
+
+void Logger::shutdown() {
+  if (!m_running.exchange(false)) return;
+
+  {
+    // A writer between its check and the wait would miss the notify
+    std::lock_guard<std::mutex> lock(m_wake_mutex);
+  }
+  m_wake.notify_one();
+  if (m_writer_thread.joinable()) {
+    m_writer_thread.join();
+  }
+  flush();
+}
+
+void Logger::run_writer() {
+  t_is_writer = true;
+  while (m_running) {
+    const int64_t next_report_ms = report_suppressed(false);
+    {
+      std::lock_guard<std::mutex> lock(m_write_mutex);
+      drain();
+    }
+
+    std::unique_lock<std::mutex> lock(m_wake_mutex);
+    m_writer_idle.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (has_pending_entries()) {
+      // More came in while writing, batch whatever arrives in the next few
+      // milliseconds into one write. A full ring cuts this short.
+      m_writer_idle.store(false, std::memory_order_relaxed);
+      m_wake.wait_for(lock, std::chrono::milliseconds(10));
+      continue;
+    }
+
+    // Nothing queued, sleep until commit_entry() or shutdown() wakes us or
+    // a rate limit window with suppressed messages ends
+    auto woken = [this] { return !m_writer_idle.load(std::memory_order_relaxed) || !m_running; };
+    if (next_report_ms >= 0) {
+      m_wake.wait_for(lock, std::chrono::milliseconds(next_report_ms), woken);
+    } else {
+      m_wake.wait(lock, woken);
+    }
+    m_writer_idle.store(false, std::memory_order_relaxed);
+  }
+}
+
+void Logger::drain() {
+  struct Pending {
+    int64_t timestamp_ns;
+    Ring* ring;
+    size_t index;
+  };
+
+  static std::vector<Pending> s_pending;
+  static std::string s_console;
+  static std::string s_file;
+  s_pending.clear();
+  s_console.clear();
+  s_file.clear();
+
+  std::vector<Ring*> rings;
+  {
+    std::lock_guard<std::mutex> lock(m_rings_mutex);
+    for (const auto& ring : m_rings) rings.push_back(ring.get());
+  }
+
+  std::vector<size_t> heads(rings.size());
+  uint64_t dropped = 0;
+  for (size_t r = 0; r < rings.size(); ++r) {
+    Ring* ring = rings[r];
+    heads[r] = ring->head.load(std::memory_order_acquire);
+    for (size_t i = ring->tail.load(std::memory_order_relaxed); i != heads[r]; ++i) {
+      s_pending.push_back({ring->entries[i % Ring::kCapacity].timestamp_ns, ring, i});
+    }
+    dropped += ring->dropped.exchange(0, std::memory_order_relaxed);
+  }
+
+  if (s_pending.empty() && dropped == 0) return;
+
+  // Interleave the threads in the order the messages were logged
+  std::stable_sort(s_pending.begin(), s_pending.end(),
+                   [](const Pending& a, const Pending& b) { return a.timestamp_ns < b.timestamp_ns; });
+
+  bool to_file;
+  {
+    std::lock_guard<std::mutex> lock(m_log_mutex);
+    to_file = m_log_file && m_log_file->stream.good();
+  }
+
+  for (const Pending& pending : s_pending) {
+    const Ring::Entry& entry = pending.ring->entries[pending.index % Ring::kCapacity];
+    append_log_line(s_console, entry.level, entry.timestamp_ns, entry.text);
+    if (to_file) append_log_line_no_color(s_file, entry.level, entry.timestamp_ns, entry.text);
+  }
+  if (dropped > 0) {
+    std::string msg = std::format("Log rings overflowed, dropped {} messages", dropped);
+    append_log_line(s_console, LogLevel::Warn, monotonic_ns(), msg);
+    if (to_file) append_log_line_no_color(s_file, LogLevel::Warn, monotonic_ns(), msg);
+  }
+
+  for (size_t r = 0; r < rings.size(); ++r) {
+    rings[r]->tail.store(heads[r], std::memory_order_release);
+  }
+
+  std::cout.write(s_console.data(), static_cast<std::streamsize>(s_console.size()));
+  std::cout.flush();
 
-  if (m_log_file && m_log_file->stream.good()) {
-      m_log_file->stream << format_as_log_no_color(lvl, msg) << std::endl;
+  if (to_file) {
+    std::lock_guard<std::mutex> lock(m_log_mutex);
+    m_log_file->stream.write(s_file.data(), static_cast<std::streamsize>(s_file.size()));
+    m_log_file->stream.flush();
   }
 }
 
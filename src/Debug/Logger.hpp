@@ -1,9 +1,15 @@
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
+#include <iterator>
 #include <mutex>
 #include <string>
+#include <string_view>
 #include <memory>
 #include <format>
+#include <thread>
+#include <vector>
 #include "Core/Application.hpp"
 
 /* If LogFatal() should terminate the app with LOG_FATAL_EXIT_CODE */
@@ -12,7 +18,11 @@
 #define LOG_FATAL_EXIT_CODE 1
 #endif
 
-#define LOG_DEBUG_OUTPUT
+/* Calls below this level compile to nothing, set through IZO_LOG_MIN_LEVEL
+   in CMake (0 = Trace ... 5 = Fatal) */
+#ifndef IZO_LOG_MIN_LEVEL
+#define IZO_LOG_MIN_LEVEL 0
+#endif
 
 namespace Izo {
 
@@ -25,6 +35,54 @@ enum class LogLevel {
     Fatal
 };
 
+/* Top-level source directory of a log call, each has its own runtime level */
+enum class LogSubsystem {
+    Core = 0,
+    Debug,
+    Geometry,
+    Graphics,
+    HAL,
+    Input,
+    Motion,
+    Platform,
+    UI,
+    Views,
+    Other,
+    Count
+};
+
+constexpr LogSubsystem log_subsystem_from_path(std::string_view path) {
+    constexpr std::string_view names[] = {"Core", "Debug", "Geometry", "Graphics", "HAL",
+                                          "Input", "Motion", "Platform", "UI", "Views"};
+    size_t src = path.rfind("src/");
+    if (src == std::string_view::npos) return LogSubsystem::Other;
+    std::string_view rest = path.substr(src + 4);
+    std::string_view dir = rest.substr(0, rest.find('/'));
+    for (size_t i = 0; i < std::size(names); ++i) {
+        if (dir == names[i]) return static_cast<LogSubsystem>(i);
+    }
+    return LogSubsystem::Other;
+}
+
+/* Per call site state: subsystem and a one second message budget */
+struct LogSite {
+    LogSubsystem subsystem;
+    const char* file;
+    int line;
+
+    std::atomic<int64_t> window_start_ms{0};
+    std::atomic<uint32_t> count{0};
+    std::atomic<uint32_t> suppressed{0};
+};
+
+/* What a thread does when its log ring is full */
+enum class LogOverflowPolicy {
+    DropNewest,  // Drop Trace/Debug/Info, wait for space for Warn and above
+    Block        // Always wait for the writer thread
+};
+
+/* Messages are formatted on the calling thread into a per-thread ring and
+   written to the console and log file by a background writer thread. */
 class Logger {
 public:
     static Logger& the();
@@ -32,35 +90,55 @@ public:
     void enable_logging_to_file();
     void log(LogLevel lvl, const std::string& msg);
 
+    /* Writes every queued message before returning */
+    void flush();
+
+    void set_level(LogSubsystem subsystem, LogLevel level);
+    LogLevel level(LogSubsystem subsystem) const;
+    static const char* subsystem_name(LogSubsystem subsystem);
+
+    /* Messages each call site may log per second, 0 disables the limit */
+    void set_rate_limit(uint32_t per_second) { m_rate_limit = per_second; }
+
+    /* Checks the subsystem level and the rate limit of site */
+    bool should_log(LogSite& site, LogLevel lvl) {
+        if (static_cast<int>(lvl) < m_levels[static_cast<int>(site.subsystem)].load(std::memory_order_relaxed))
+            return false;
+        return lvl == LogLevel::Fatal || within_rate_limit(site);
+    }
+    void set_overflow_policy(LogOverflowPolicy policy) { m_overflow_policy = policy; }
+
     // Template functions that handle std::format internally
     template<typename... Args>
     void trace(std::format_string<Args...> fmt, Args&&... args) {
-        log(LogLevel::Trace, std::format(fmt, std::forward<Args>(args)...));
+        log_format(LogLevel::Trace, fmt, std::forward<Args>(args)...);
     }
 
     template<typename... Args>
     void debug(std::format_string<Args...> fmt, Args&&... args) {
-        log(LogLevel::Debug, std::format(fmt, std::forward<Args>(args)...));
+        log_format(LogLevel::Debug, fmt, std::forward<Args>(args)...);
     }
 
     template<typename... Args>
     void info(std::format_string<Args...> fmt, Args&&... args) {
-        log(LogLevel::Info, std::format(fmt, std::forward<Args>(args)...));
+        log_format(LogLevel::Info, fmt, std::forward<Args>(args)...);
     }
 
     template<typename... Args>
     void warn(std::format_string<Args...> fmt, Args&&... args) {
-        log(LogLevel::Warn, std::format(fmt, std::forward<Args>(args)...));
+        log_format(LogLevel::Warn, fmt, std::forward<Args>(args)...);
     }
 
     template<typename... Args>
     void error(std::format_string<Args...> fmt, Args&&... args) {
-        log(LogLevel::Error, std::format(fmt, std::forward<Args>(args)...));
+        log_format(LogLevel::Error, fmt, std::forward<Args>(args)...);
     }
 
     template<typename... Args>
     void fatal(std::format_string<Args...> fmt, Args&&... args) {
-        log(LogLevel::Fatal, std::format(fmt, std::forward<Args>(args)...));
+        log_format(LogLevel::Fatal, fmt, std::forward<Args>(args)...);
+        // The app may exit right away, get the crash report out first
+        flush();
         #ifdef LOG_FATAL_TERMINATES_APP
             Application::the().quit(LOG_FATAL_EXIT_CODE);
         #endif
@@ -72,32 +150,103 @@ private:
     Logger(const Logger&) = delete;
     Logger& operator=(const Logger&) = delete;
 
+    template<typename... Args>
+    void log_format(LogLevel lvl, std::format_string<Args...> fmt, Args&&... args) {
+        if (std::string* text = begin_entry(lvl)) {
+            std::format_to(std::back_inserter(*text), fmt, std::forward<Args>(args)...);
+            commit_entry();
+        }
+    }
+
+    struct Ring;
     struct LogFile;
+
+    /* Reserves a slot in the calling thread's ring, nullptr if dropped.
+       The returned string is empty and owned by the slot. */
+    std::string* begin_entry(LogLevel lvl);
+    void commit_entry();
+
+    bool within_rate_limit(LogSite& site);
+    bool has_pending_entries();
+    /* Logs the suppressed counts of sites whose window ended (every site
+       if all), returns the ms until the next one ends or -1 */
+    int64_t report_suppressed(bool all);
+
+    Ring* thread_ring();
+    void run_writer();
+    void shutdown();
+    /* Writes all committed entries, callers hold m_write_mutex */
+    void drain();
+
     std::mutex               m_log_mutex;
     std::unique_ptr<LogFile> m_log_file;
+
+    std::mutex               m_rings_mutex;
+    std::vector<std::unique_ptr<Ring>> m_rings;
+
+    std::mutex               m_write_mutex;
+    std::mutex               m_wake_mutex;
+    std::condition_variable  m_wake;
+    std::atomic<bool>        m_writer_idle{false};
+    std::atomic<bool>        m_running{true};
+    std::thread              m_writer_thread;
+    std::atomic<LogOverflowPolicy> m_overflow_policy{LogOverflowPolicy::DropNewest};
+
+    std::atomic<int>         m_levels[static_cast<int>(LogSubsystem::Count)]{};
+    std::atomic<uint32_t>    m_rate_limit{50};
+    // Sites that suppressed messages in their current window
+    std::mutex               m_suppressed_mutex;
+    std::vector<LogSite*>    m_suppressed_sites;
 };
 
+/* Every call site gets a static LogSite; arguments are only evaluated when
+   the message passes the level and rate checks */
+#define IZO_LOG_AT(level, method, fmt, ...) \
+    do { \
+        static ::Izo::LogSite izo_log_site{::Izo::log_subsystem_from_path(__FILE__), __FILE__, __LINE__}; \
+        if (::Izo::Logger::the().should_log(izo_log_site, level)) \
+            ::Izo::Logger::the().method(fmt, ##__VA_ARGS__); \
+    } while (0)
+
+/* Compiled out calls still type-check their arguments */
+#define IZO_LOG_DISABLED(method, fmt, ...) \
+    do { \
+        if constexpr (false) ::Izo::Logger::the().method(fmt, ##__VA_ARGS__); \
+    } while (0)
+
 /* Macro definitions for different log levels */
-#define LogTrace(fmt, ...) \
-    Logger::the().trace(fmt, ##__VA_ARGS__)
+#if IZO_LOG_MIN_LEVEL <= 0
+#define LogTrace(fmt, ...) IZO_LOG_AT(::Izo::LogLevel::Trace, trace, fmt, ##__VA_ARGS__)
+#else
+#define LogTrace(fmt, ...) IZO_LOG_DISABLED(trace, fmt, ##__VA_ARGS__)
+#endif
 
-#ifdef LOG_DEBUG_OUTPUT
-#define LogDebug(fmt, ...) \
-    Logger::the().debug(fmt, ##__VA_ARGS__)
+#if IZO_LOG_MIN_LEVEL <= 1
+#define LogDebug(fmt, ...) IZO_LOG_AT(::Izo::LogLevel::Debug, debug, fmt, ##__VA_ARGS__)
 #else
-#define LogDebug(fmt, ...)
+#define LogDebug(fmt, ...) IZO_LOG_DISABLED(debug, fmt, ##__VA_ARGS__)
 #endif
 
-#define LogInfo(fmt, ...) \
-    Logger::the().info(fmt, ##__VA_ARGS__)
+#if IZO_LOG_MIN_LEVEL <= 2
+#define LogInfo(fmt, ...) IZO_LOG_AT(::Izo::LogLevel::Info, info, fmt, ##__VA_ARGS__)
+#else
+#define LogInfo(fmt, ...) IZO_LOG_DISABLED(info, fmt, ##__VA_ARGS__)
+#endif
 
-#define LogWarn(fmt, ...) \
-    Logger::the().warn(fmt, ##__VA_ARGS__)
+#if IZO_LOG_MIN_LEVEL <= 3
+#define LogWarn(fmt, ...) IZO_LOG_AT(::Izo::LogLevel::Warn, warn, fmt, ##__VA_ARGS__)
+#else
+#define LogWarn(fmt, ...) IZO_LOG_DISABLED(warn, fmt, ##__VA_ARGS__)
+#endif
 
-#define LogError(fmt, ...) \
-    Logger::the().error(fmt, ##__VA_ARGS__)
+#if IZO_LOG_MIN_LEVEL <= 4
+#define LogError(fmt, ...) IZO_LOG_AT(::Izo::LogLevel::Error, error, fmt, ##__VA_ARGS__)
+#else
+#define LogError(fmt, ...) IZO_LOG_DISABLED(error, fmt, ##__VA_ARGS__)
+#endif
 
+// Fatal is never compiled out
 #define LogFatal(fmt, ...) \
-    Logger::the().fatal("At {}:{}: " fmt, __FILE__, __LINE__, ##__VA_ARGS__)
+    IZO_LOG_AT(::Izo::LogLevel::Fatal, fatal, "At {}:{}: " fmt, __FILE__, __LINE__, ##__VA_ARGS__)
 
 }
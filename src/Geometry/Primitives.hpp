@@ -80,6 +80,10 @@ struct Rect {
     constexpr Rect(T x_value, T y_value, T w_value, T h_value)
         : x(x_value), y(y_value), w(w_value), h(h_value) {}
 
+    constexpr bool operator==(const Rect& other) const {
+        return x == other.x && y == other.y && w == other.w && h == other.h;
+    }
+
     constexpr T left() const { return x; }
     constexpr T top() const { return y; }
     constexpr T right() const { return x + w; }
@@ -96,6 +100,10 @@ struct Rect {
         return contains(point.x, point.y);
     }
 
+    constexpr bool contains(const Rect& other) const {
+        return other.x >= x && other.right() <= right() && other.y >= y && other.bottom() <= bottom();
+    }
+
     constexpr bool intersects(const Rect& other) const {
         return x < other.right() && right() > other.x && y < other.bottom() && bottom() > other.y;
     }
@@ -1,4 +1,5 @@
 #include "Graphics/Canvas.hpp"
+#include <cstdlib>
 #include <cstring>
 
 #define STB_IMAGE_WRITE_IMPLEMENTATION
@@ -7,12 +8,12 @@
 namespace Izo {
 
 Canvas::Canvas(int width, int height) 
-    : m_width(width), m_height(height), m_owns_memory(true) {
+    : m_width(width), m_height(height), m_stride(width), m_owns_memory(true) {
     m_pixels = new uint32_t[width * height];
 }
 
-Canvas::Canvas(int width, int height, uint32_t* pixels)
-    : m_width(width), m_height(height), m_pixels(pixels), m_owns_memory(false) {
+Canvas::Canvas(int width, int height, uint32_t* pixels, int stride)
+    : m_width(width), m_height(height), m_stride(stride > 0 ? stride : width), m_pixels(pixels), m_owns_memory(false) {
 }
 
 Canvas::~Canvas() {
@@ -24,25 +25,30 @@ Canvas::~Canvas() {
 
 void Canvas::clear(Color color) {
     uint32_t c = color.as_argb();
-    if (c == 0) {
-        std::memset(m_pixels, 0, m_width * m_height * sizeof(uint32_t));
-    } else {
-        size_t count = m_width * m_height;
-        for (size_t i = 0; i < count; ++i) {
-            m_pixels[i] = c;
+    // Padding between rows may belong to someone else, only touch it when there is none
+    int rows = m_stride == m_width ? 1 : m_height;
+    size_t count = m_stride == m_width ? static_cast<size_t>(m_width) * m_height : m_width;
+    for (int y = 0; y < rows; ++y) {
+        uint32_t* pixels = row(y);
+        if (c == 0) {
+            std::memset(pixels, 0, count * sizeof(uint32_t));
+        } else {
+            for (size_t i = 0; i < count; ++i) {
+                pixels[i] = c;
+            }
         }
     }
 }
 
 void Canvas::set_pixel(IntPoint point, uint32_t color) {
     if (point.x >= 0 && point.x < m_width && point.y >= 0 && point.y < m_height) {
-        m_pixels[point.y * m_width + point.x] = color;
+        m_pixels[point.y * m_stride + point.x] = color;
     }
 }
 
 uint32_t Canvas::pixel_at(IntPoint point) const {
     if (point.x >= 0 && point.x < m_width && point.y >= 0 && point.y < m_height) {
-        return m_pixels[point.y * m_width + point.x];
+        return m_pixels[point.y * m_stride + point.x];
     }
     return 0;
 }
@@ -54,16 +60,48 @@ void Canvas::resize(int width, int height) {
     if (m_owns_memory) {
         delete[] m_pixels;
         m_pixels = new uint32_t[width * height];
+        m_stride = width;
     }
 
     m_width = width;
     m_height = height;
 }
 
+void Canvas::attach(uint32_t* pixels, int width, int height, int stride) {
+    if (m_owns_memory) return;
+
+    m_pixels = pixels;
+    m_width = width;
+    m_height = height;
+    m_stride = stride > 0 ? stride : width;
+}
+
+void Canvas::scroll_rect(const IntRect& rect, int dy) {
+    IntRect area = rect.intersection({0, 0, m_width, m_height});
+    if (area.w <= 0 || area.h <= 0 || dy == 0) return;
+    if (std::abs(dy) >= area.h) return;
+
+    const size_t row_bytes = area.w * sizeof(uint32_t);
+    const int rows = area.h - std::abs(dy);
+
+    // Walk against the direction of the move so source rows are read before being overwritten
+    if (dy > 0) {
+        for (int row = rows - 1; row >= 0; --row) {
+            uint32_t* src = m_pixels + (area.y + row) * m_stride + area.x;
+            std::memmove(src + dy * m_stride, src, row_bytes);
+        }
+    } else {
+        for (int row = 0; row < rows; ++row) {
+            uint32_t* dst = m_pixels + (area.y + row) * m_stride + area.x;
+            std::memmove(dst, dst - dy * m_stride, row_bytes);
+        }
+    }
+}
+
 bool Canvas::save_to_file(const std::string& path) {
     std::vector<uint32_t> rgba(m_width * m_height);
     for (size_t i = 0; i < m_width * m_height; ++i) {
-        uint32_t p = m_pixels[i];
+        uint32_t p = m_pixels[(i / m_width) * m_stride + i % m_width];
         // ARGB -> RGBA
         // A = (p >> 24) & 0xFF
         // R = (p >> 16) & 0xFF
@@ -7,18 +7,25 @@ namespace Izo {
 class Canvas {
 public:
     Canvas(int width, int height);
-    Canvas(int width, int height, uint32_t* pixels);
+    /* Memory owned by someone else, e.g. a framebuffer. stride is the
+       distance between rows in pixels, 0 for rows without padding. */
+    Canvas(int width, int height, uint32_t* pixels, int stride = 0);
     Canvas(const Canvas&) = delete;
     Canvas(const Canvas&&) = delete;
     ~Canvas();
 
     int width() const { return m_width; }
     int height() const { return m_height; }
+    /* Pixels from one row to the next, at least width() */
+    int stride() const { return m_stride; }
 
     uint32_t* pixels() { return m_pixels; }
     const uint32_t* pixels() const { return m_pixels; }
 
-    size_t size_bytes() const { return m_width * m_height * sizeof(uint32_t); }
+    uint32_t* row(int y) { return m_pixels + static_cast<size_t>(y) * m_stride; }
+    const uint32_t* row(int y) const { return m_pixels + static_cast<size_t>(y) * m_stride; }
+
+    size_t size_bytes() const { return m_stride * m_height * sizeof(uint32_t); }
 
     void clear(Color color);
 
@@ -27,6 +34,11 @@ public:
     uint32_t pixel_at(IntPoint point) const;
 
     void resize(int width, int height);
+    /* Moves a canvas over external memory to other external memory */
+    void attach(uint32_t* pixels, int width, int height, int stride = 0);
+
+    /* Moves the pixels inside rect vertically by dy, rows leaving the rect are dropped */
+    void scroll_rect(const IntRect& rect, int dy);
 
     bool save_to_file(const std::string& path);
 
@@ -34,6 +46,7 @@ public:
 private:
     int m_width;
     int m_height;
+    int m_stride;
     uint32_t* m_pixels;
     bool m_owns_memory;
 };
@@ -37,6 +37,11 @@ void Dialog::run_layout_pass() {
         return;
     }
 
+    if (!parent_changed && !layout_dirty()) {
+        layout_dirty_subtrees();
+        return;
+    }
+
     m_last_parent_w = parent_w;
     m_last_parent_h = parent_h;
 
@@ -0,0 +1,53 @@
+#include "Graphics/DisplayList.hpp"
+
+#include <iterator>
+
+#include "Graphics/Canvas.hpp"
+#include "Graphics/Font.hpp"
+#include "Graphics/Image.hpp"
+#include "Graphics/Painter.hpp"
+
+namespace Izo {
+
+template <typename... Ts>
+struct Overloaded : Ts... {
+    using Ts::operator()...;
+};
+
+void DisplayList::replay(Painter& painter) const {
+    for (const Command& command : m_commands) {
+        std::visit(Overloaded{
+            [&](const PushClip& c) { painter.push_rounded_clip(c.rect, c.radius); },
+            [&](const PopClip&) { painter.pop_clip(); },
+            [&](const SetGlobalAlpha& c) { painter.set_global_alpha(c.alpha); },
+            [&](const PushTranslate& c) { painter.push_translate(c.offset); },
+            [&](const PopTranslate&) { painter.pop_translate(); },
+            [&](const ResetClipsAndTransform&) { painter.reset_clips_and_transform(); },
+            [&](const DrawPixel& c) { painter.draw_pixel(c.point, c.color); },
+            [&](const FillRect& c) { painter.fill_rect(c.rect, c.color); },
+            [&](const ClearRect& c) { painter.clear_rect(c.rect, c.color); },
+            [&](const OutlineRect& c) { painter.outline_rect(c.rect, c.color); },
+            [&](const DrawLine& c) { painter.draw_line(c.p1, c.p2, c.color); },
+            [&](const FillRoundedRect& c) { painter.fill_rounded_rect(c.rect, c.radius, c.color, c.corners); },
+            [&](const DrawRoundedRect& c) { painter.draw_rounded_rect(c.rect, c.radius, c.color, c.thickness); },
+            [&](const DropShadowRect& c) { painter.drop_shadow_rect(c.rect, c.blur_radius, c.color, c.roundness, c.offset); },
+            [&](const BlurRect& c) { painter.draw_blur_rect(c.rect, c.blur_level); },
+            [&](const DrawText& c) { c.font->draw_text(painter, c.pos, c.text, c.color); },
+            [&](const DrawImage& c) { c.image->draw(painter, c.pos); },
+            [&](const DrawImageScaled& c) { c.image->draw_scaled(painter, c.rect, c.anchor); },
+            [&](const ScrollRect& c) { painter.canvas()->scroll_rect(c.rect, c.dy); },
+        }, command);
+    }
+}
+
+void DisplayList::append(DisplayList&& other) {
+    if (m_commands.empty()) {
+        m_commands.swap(other.m_commands);
+        return;
+    }
+    m_commands.insert(m_commands.end(), std::make_move_iterator(other.m_commands.begin()),
+                      std::make_move_iterator(other.m_commands.end()));
+    other.m_commands.clear();
+}
+
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <string>
+#include <variant>
+#include <vector>
+
+#include "Geometry/Primitives.hpp"
+#include "Graphics/Color.hpp"
+#include "UI/Enums.hpp"
+
+namespace Izo {
+
+class Font;
+class Image;
+class Painter;
+
+/* Painter calls recorded on the UI thread, replayed on the render thread.
+   Text and images are kept as one command each and rasterized on replay;
+   the fonts and images they point to must stay alive until then, see
+   ResourceManagerBase::wait_for_readers(). */
+class DisplayList {
+public:
+    void push_clip(const IntRect& rect, int radius) { m_commands.push_back(PushClip{rect, radius}); }
+    void pop_clip() { m_commands.push_back(PopClip{}); }
+    void set_global_alpha(float alpha) { m_commands.push_back(SetGlobalAlpha{alpha}); }
+    void push_translate(IntPoint offset) { m_commands.push_back(PushTranslate{offset}); }
+    void pop_translate() { m_commands.push_back(PopTranslate{}); }
+    void reset_clips_and_transform() { m_commands.push_back(ResetClipsAndTransform{}); }
+
+    void draw_pixel(IntPoint point, Color color) { m_commands.push_back(DrawPixel{point, color}); }
+    void fill_rect(const IntRect& rect, Color color) { m_commands.push_back(FillRect{rect, color}); }
+    void clear_rect(const IntRect& rect, Color color) { m_commands.push_back(ClearRect{rect, color}); }
+    void outline_rect(const IntRect& rect, Color color) { m_commands.push_back(OutlineRect{rect, color}); }
+    void draw_line(IntPoint p1, IntPoint p2, Color color) { m_commands.push_back(DrawLine{p1, p2, color}); }
+    void fill_rounded_rect(const IntRect& rect, int radius, Color color, int corners) {
+        m_commands.push_back(FillRoundedRect{rect, radius, color, corners});
+    }
+    void draw_rounded_rect(const IntRect& rect, int radius, Color color, int thickness) {
+        m_commands.push_back(DrawRoundedRect{rect, radius, color, thickness});
+    }
+    void drop_shadow_rect(const IntRect& rect, int blur_radius, Color color, int roundness, IntPoint offset) {
+        m_commands.push_back(DropShadowRect{rect, blur_radius, color, roundness, offset});
+    }
+    void draw_blur_rect(const IntRect& rect, int blur_level) { m_commands.push_back(BlurRect{rect, blur_level}); }
+
+    void draw_text(Font& font, IntPoint pos, const std::string& text, Color color) {
+        m_commands.push_back(DrawText{&font, pos, text, color});
+    }
+    void draw_image(Image& image, IntPoint pos) { m_commands.push_back(DrawImage{&image, pos}); }
+    void draw_image_scaled(Image& image, const IntRect& rect, Anchor anchor) {
+        m_commands.push_back(DrawImageScaled{&image, rect, anchor});
+    }
+
+    /* Moves already rendered pixels, see Canvas::scroll_rect() */
+    void scroll_rect(const IntRect& rect, int dy) { m_commands.push_back(ScrollRect{rect, dy}); }
+
+    /* Draws everything into painter, which must not be recording itself */
+    void replay(Painter& painter) const;
+
+    void append(DisplayList&& other);
+    /* Keeps the memory, lists are reused from frame to frame */
+    void clear() { m_commands.clear(); }
+    bool empty() const { return m_commands.empty(); }
+    size_t size() const { return m_commands.size(); }
+
+private:
+    struct PushClip { IntRect rect; int radius; };
+    struct PopClip {};
+    struct SetGlobalAlpha { float alpha; };
+    struct PushTranslate { IntPoint offset; };
+    struct PopTranslate {};
+    struct ResetClipsAndTransform {};
+    struct DrawPixel { IntPoint point; Color color; };
+    struct FillRect { IntRect rect; Color color; };
+    struct ClearRect { IntRect rect; Color color; };
+    struct OutlineRect { IntRect rect; Color color; };
+    struct DrawLine { IntPoint p1; IntPoint p2; Color color; };
+    struct FillRoundedRect { IntRect rect; int radius; Color color; int corners; };
+    struct DrawRoundedRect { IntRect rect; int radius; Color color; int thickness; };
+    struct DropShadowRect { IntRect rect; int blur_radius; Color color; int roundness; IntPoint offset; };
+    struct BlurRect { IntRect rect; int blur_level; };
+    struct DrawText { Font* font; IntPoint pos; std::string text; Color color; };
+    struct DrawImage { Image* image; IntPoint pos; };
+    struct DrawImageScaled { Image* image; IntRect rect; Anchor anchor; };
+    struct ScrollRect { IntRect rect; int dy; };
+
+    using Command = std::variant<PushClip, PopClip, SetGlobalAlpha, PushTranslate, PopTranslate,
+                                 ResetClipsAndTransform, DrawPixel, FillRect, ClearRect, OutlineRect,
+                                 DrawLine, FillRoundedRect, DrawRoundedRect, DropShadowRect, BlurRect,
+                                 DrawText, DrawImage, DrawImageScaled, ScrollRect>;
+
+    std::vector<Command> m_commands;
+};
+
+}
@@ -1,9 +1,10 @@
 #include "Graphics/Font.hpp"
 
-#include <cstdio>
 #include <sstream>
 
+#include "Core/ResourcePack.hpp"
 #include "Debug/Logger.hpp"
+#include "Graphics/DisplayList.hpp"
 
 #define STB_TRUETYPE_IMPLEMENTATION
 #include "Lib/stb_truetype.h"
@@ -12,7 +13,6 @@ namespace Izo {
 
 Font::Font(const std::string& path, float size)
     : path(path), font_size(size), font_loaded(false) {
-    info = std::make_unique<stbtt_fontinfo>();
     load();
 }
 
@@ -20,28 +20,32 @@ Font::~Font() {
 }
 
 void Font::load() {
-    FILE* f = std::fopen(path.c_str(), "rb");
-    if (!f) {
-        LogError("Failed to open font file: {}", path);
-        return;
+    // Everything drawing needs is rasterized and measured here, so the file
+    // is not touched afterwards. The asset watcher may rewrite or truncate
+    // a loose font while it is in use, and the render thread draws text.
+    const unsigned char* font_data = nullptr;
+    MappedFile file;
+    auto packed = ResourcePack::the().find(path);
+    if (!packed.empty()) {
+        font_data = packed.data();
+    } else {
+        file = File::map(path, MappedFile::Access::WillNeed);
+        if (!file.valid()) {
+            LogError("Failed to open font file: {}", path);
+            return;
+        }
+        font_data = file.data();
     }
 
-    std::fseek(f, 0, SEEK_END);
-    long size = std::ftell(f);
-    std::fseek(f, 0, SEEK_SET);
-
-    data.resize(size);
-    std::fread(data.data(), 1, size, f);
-    std::fclose(f);
-
-    if (!stbtt_InitFont(info.get(), data.data(), 0)) {
+    stbtt_fontinfo info;
+    if (!stbtt_InitFont(&info, font_data, 0)) {
         LogError("Failed to init font");
         return;
     }
 
-    scale = stbtt_ScaleForPixelHeight(info.get(), font_size);
+    scale = stbtt_ScaleForPixelHeight(&info, font_size);
 
-    stbtt_GetFontVMetrics(info.get(), &ascent, &descent, &lineGap);
+    stbtt_GetFontVMetrics(&info, &ascent, &descent, &lineGap);
     baseline = (int)(ascent * scale);
 
     atlas.width = 512;
@@ -54,7 +58,7 @@ void Font::load() {
 
     for (int i = 32; i < 127; i++) {
         int x1, y1, x2, y2;
-        stbtt_GetCodepointBitmapBox(info.get(), i, scale, scale, &x1, &y1, &x2, &y2);
+        stbtt_GetCodepointBitmapBox(&info, i, scale, scale, &x1, &y1, &x2, &y2);
 
         int w = x2 - x1;
         int h = y2 - y1;
@@ -68,16 +72,18 @@ void Font::load() {
         if (curY + h >= atlas.height)
             break;
 
-        stbtt_MakeCodepointBitmap(info.get(), atlas.pixels.data() + (curY * atlas.width + curX),
+        stbtt_MakeCodepointBitmap(&info, atlas.pixels.data() + (curY * atlas.width + curX),
                                   w, h, atlas.width, scale, scale, i);
 
         glyphs[i].x0 = curX;
         glyphs[i].y0 = curY;
         glyphs[i].x1 = x1;
         glyphs[i].y1 = y1;
+        glyphs[i].w = w;
+        glyphs[i].h = h;
 
         int adv, lsb;
-        stbtt_GetCodepointHMetrics(info.get(), i, &adv, &lsb);
+        stbtt_GetCodepointHMetrics(&info, i, &adv, &lsb);
         glyphs[i].advance = (int)(adv * scale);
         glyphs[i].lsb = (int)(lsb * scale);
 
@@ -103,6 +109,11 @@ void Font::draw_text(Painter& painter, IntPoint pos, const std::string& text, Co
     if (!font_loaded)
         return;
 
+    if (DisplayList* list = painter.recording()) {
+        list->draw_text(*this, pos, text, color);
+        return;
+    }
+
     int curX = pos.x;
 
     for (char c : text) {
@@ -111,13 +122,11 @@ void Font::draw_text(Painter& painter, IntPoint pos, const std::string& text, Co
 
         const Glyph& g = glyphs[(int)c];
 
-        int x1, y1, x2, y2;
-        stbtt_GetCodepointBitmapBox(info.get(), c, scale, scale, &x1, &y1, &x2, &y2);
-        int gw = x2 - x1;
-        int gh = y2 - y1;
+        int gw = g.w;
+        int gh = g.h;
 
-        int drawX = curX + x1;
-        int drawY = pos.y + baseline + y1;
+        int drawX = curX + g.x1;
+        int drawY = pos.y + baseline + g.y1;
 
         for (int row = 0; row < gh; row++) {
             for (int col = 0; col < gw; col++) {
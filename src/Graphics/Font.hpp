@@ -7,15 +7,15 @@
 #include "Geometry/Primitives.hpp"
 #include "Graphics/Painter.hpp"
 #include "Graphics/Color.hpp"
+#include "Core/File.hpp"
 #include "Core/ResourceManager.hpp"
 #include "UI/Enums.hpp"
 
-typedef struct stbtt_fontinfo stbtt_fontinfo;
-
 namespace Izo {
 
 struct Glyph {
     int x0, y0, x1, y1;
+    int w, h;
     int advance, lsb;
 };
 
@@ -30,6 +30,8 @@ public:
 
     bool valid() const { return font_loaded; }
     float size() const { return font_size; }
+    /* The file is only read while loading, the glyph atlas is all that stays */
+    size_t memory_bytes() const { return sizeof(Font) + atlas.pixels.capacity(); }
     int height() const { return (int)((ascent - descent + lineGap) * scale); }
     int width(const std::string& text) const;
 
@@ -45,15 +47,13 @@ private:
     float font_size;
     float scale;
     bool font_loaded;
-    std::vector<unsigned char> data;
-    std::unique_ptr<stbtt_fontinfo> info;
 
     struct Atlas {
         int width, height;
         std::vector<unsigned char> pixels;
     } atlas;
 
-    Glyph glyphs[128]; 
+    Glyph glyphs[128]{};
 };
 
 using FontManager = ResourceManager<Font>;
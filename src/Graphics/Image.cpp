@@ -1,5 +1,8 @@
 #include "Core/Application.hpp"
+#include "Core/File.hpp"
+#include "Core/ResourcePack.hpp"
 #include "Debug/Logger.hpp"
+#include "Graphics/DisplayList.hpp"
 #include "Graphics/Image.hpp"
 #include "Graphics/Painter.hpp"
 #include "Graphics/Color.hpp"
@@ -10,16 +13,63 @@
 namespace Izo {
 
 Image::Image(const std::string& path) {
-    data = stbi_load(path.c_str(), &w, &h, &channels, 4); 
-
-    if (!data) {
+    if (!read_pixels(path)) {
         LogError("Failed to load image: {}", path);
     }
 }
 
+Image::Image(int width, int height, Color color) : w(width), h(height), channels(4) {
+    // Freed like stb_image's own buffers
+    decoded = static_cast<unsigned char*>(STBI_MALLOC(static_cast<size_t>(w) * h * 4));
+    for (int i = 0; i < w * h; ++i) {
+        decoded[i * 4 + 0] = color.r;
+        decoded[i * 4 + 1] = color.g;
+        decoded[i * 4 + 2] = color.b;
+        decoded[i * 4 + 3] = color.a;
+    }
+    data = decoded;
+}
+
+bool Image::reload(const std::string& path) {
+    if (!read_pixels(path)) {
+        LogError("Failed to reload image: {}", path);
+        return false;
+    }
+    return true;
+}
+
+bool Image::read_pixels(const std::string& path) {
+    // Packed images are already decoded and used straight from the mapping
+    if (auto packed = ResourcePack::the().find_image(path)) {
+        if (decoded) stbi_image_free(decoded);
+        decoded = nullptr;
+        data = packed->pixels.data();
+        w = packed->width;
+        h = packed->height;
+        channels = 4;
+        return true;
+    }
+
+    // Decoded straight from the page cache, the mapping is dropped afterwards
+    MappedFile file = File::map(path, MappedFile::Access::Sequential);
+    if (!file.valid()) return false;
+
+    int new_w, new_h, new_channels;
+    unsigned char* new_data = stbi_load_from_memory(file.data(), static_cast<int>(file.size()), &new_w, &new_h, &new_channels, 4);
+    if (!new_data) return false;
+
+    if (decoded) stbi_image_free(decoded);
+    decoded = new_data;
+    data = new_data;
+    w = new_w;
+    h = new_h;
+    channels = new_channels;
+    return true;
+}
+
 Image::~Image() {
-    if (data) {
-        stbi_image_free(data);
+    if (decoded) {
+        stbi_image_free(decoded);
     }
 }
 
@@ -27,6 +77,11 @@ void Image::draw(Painter& painter, IntPoint pos) {
     if (!data) return;
     if (!Application::the().screen_rect().contains(pos)) return;
 
+    if (DisplayList* list = painter.recording()) {
+        list->draw_image(*this, pos);
+        return;
+    }
+
     for (int iy = 0; iy < h; ++iy) {
         for (int ix = 0; ix < w; ++ix) {
             int offset = (iy * w + ix) * 4;
@@ -46,6 +101,11 @@ void Image::draw_scaled(Painter& painter, const IntRect& rect, Anchor anchor) {
     if (!data || rect.w <= 0 || rect.h <= 0) return;
     if (!Application::the().screen_rect().contains(rect.x, rect.y)) return;
 
+    if (DisplayList* list = painter.recording()) {
+        list->draw_image_scaled(*this, rect, anchor);
+        return;
+    }
+
     int dx = rect.x;
     int dy = rect.y;
     int dw = rect.w;
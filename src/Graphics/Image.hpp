@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Core/ResourceManager.hpp"
+#include "Graphics/Color.hpp"
 #include "UI/Enums.hpp"
 
 #include <string>
@@ -12,18 +13,28 @@ class Painter;
 class Image {
 public:
     Image(const std::string& path);
+    /* Solid block of color, e.g. a placeholder while the real image loads */
+    Image(int width, int height, Color color);
     ~Image();
 
+    /* Replaces the pixels with the image at path, keeps the old ones on failure */
+    bool reload(const std::string& path);
+
     bool valid() const { return data != nullptr; }
     int width() const { return w; }
+    /* Pixels served from the resource pack are file backed and not counted */
+    size_t memory_bytes() const { return sizeof(Image) + (decoded ? static_cast<size_t>(w) * h * 4 : 0); }
     int height() const { return h; }
 
     void draw(Painter& painter, IntPoint pos);
     void draw_scaled(Painter& painter, const IntRect& rect, Anchor anchor = Anchor::TopLeft);
 
 private:
+    bool read_pixels(const std::string& path);
+
     int w = 0, h = 0, channels = 0;
-    unsigned char* data = nullptr;
+    const unsigned char* data = nullptr;
+    unsigned char* decoded = nullptr;  // owned, null for packed images
 };
 
 using ImageManager = ResourceManager<Image>;
@@ -2,6 +2,7 @@
 
 #include "Graphics/Canvas.hpp"
 #include "Graphics/Color.hpp"
+#include "Graphics/DisplayList.hpp"
 
 #include <algorithm>
 #include <cmath>
@@ -136,29 +137,86 @@ static void blur_alpha_mask(std::vector<uint8_t>& alpha, int width, int height,
 }
 
 Painter::Painter(std::unique_ptr<Canvas> canvas) : m_canvas(std::move(canvas)) {
-    m_current_clip = {{0, 0, m_canvas->width(), m_canvas->height()}, 0};
+    m_current_clip = {surface_rect(), 0};
+}
+
+Painter::Painter(int width, int height) : m_width(width), m_height(height) {
+    m_current_clip = {surface_rect(), 0};
+}
+
+IntRect Painter::surface_rect() const {
+    if (m_canvas) return {0, 0, m_canvas->width(), m_canvas->height()};
+    return {0, 0, m_width, m_height};
+}
+
+void Painter::set_size(int width, int height) {
+    m_width = width;
+    m_height = height;
+    reset_clips_and_transform();
 }
 
 void Painter::set_global_alpha(float alpha) {
+    if (m_recording) m_recording->set_global_alpha(alpha);
     m_global_alpha = std::clamp(alpha, 0.0f, 1.0f);
 }
 
 void Painter::reset_clips_and_transform() {
-    m_current_clip = {{0, 0, m_canvas->width(), m_canvas->height()}, 0};
+    if (m_recording) m_recording->reset_clips_and_transform();
+    m_current_clip = {surface_rect(), 0};
     m_clip_stack.clear();
     m_translate_stack.clear();
     m_translation = {0, 0};
 }
 
+void Painter::set_overdraw_tracking(bool enabled) {
+    if (enabled == overdraw_tracking()) return;
+    if (enabled) {
+        m_overdraw_width = m_canvas->width();
+        m_overdraw.assign(static_cast<size_t>(m_canvas->width()) * m_canvas->height(), 0);
+    } else {
+        m_overdraw.clear();
+        m_overdraw.shrink_to_fit();
+        m_overdraw_width = 0;
+    }
+}
+
+void Painter::reset_overdraw() {
+    if (!overdraw_tracking()) return;
+    m_overdraw_width = m_canvas->width();
+    m_overdraw.assign(static_cast<size_t>(m_canvas->width()) * m_canvas->height(), 0);
+}
+
+void Painter::draw_overdraw_heatmap(const IntRect& rect) {
+    if (!overdraw_tracking()) return;
+
+    // Same scale as the usual GPU overdraw debug view: 1x blue, 2x green, 3x pink, 4x+ red
+    static constexpr uint32_t kHeatColors[] = {0x00000000, 0xFF3050FF, 0xFF30C040, 0xFFFF80C0, 0xFFFF3030};
+    constexpr uint32_t kHeatAlpha = 150;
+
+    IntRect area = rect.intersection({0, 0, m_canvas->width(), m_canvas->height()});
+    uint32_t* pixels = m_canvas->pixels();
+    const int stride = m_canvas->stride();
+
+    for (int y = area.y; y < area.bottom(); ++y) {
+        for (int x = area.x; x < area.right(); ++x) {
+            int writes = m_overdraw[static_cast<size_t>(y) * m_overdraw_width + x];
+            if (writes == 0) continue;
+            uint32_t& dst = pixels[y * stride + x];
+            dst = blend_argb_over(kHeatColors[std::min(writes, 4)], dst, kHeatAlpha);
+        }
+    }
+}
+
 void Painter::set_canvas(std::unique_ptr<Canvas> canvas) {
     m_canvas = std::move(canvas);
     reset_clips_and_transform();
 }
 
 void Painter::push_rounded_clip(const IntRect& rect, int radius) {
+    if (m_recording) m_recording->push_clip(rect, radius);
     m_clip_stack.push_back(m_current_clip);
     const IntRect translated = apply_translate_to_rect(rect);
-    m_current_clip = {translated.intersection(m_current_clip.rect), radius};
+    m_current_clip = {translated.intersection(m_current_clip.rect), radius, translated};
 }
 
 void Painter::push_clip(const IntRect& rect) {
@@ -166,6 +224,7 @@ void Painter::push_clip(const IntRect& rect) {
 }
 
 void Painter::pop_clip() {
+    if (m_recording) m_recording->pop_clip();
     if (!m_clip_stack.empty()) {
         m_current_clip = m_clip_stack.back();
         m_clip_stack.pop_back();
@@ -173,11 +232,13 @@ void Painter::pop_clip() {
 }
 
 void Painter::push_translate(IntPoint offset) {
+    if (m_recording) m_recording->push_translate(offset);
     m_translate_stack.push_back(m_translation);
     m_translation += offset;
 }
 
 void Painter::pop_translate() {
+    if (m_recording) m_recording->pop_translate();
     if (!m_translate_stack.empty()) {
         m_translation = m_translate_stack.back();
         m_translate_stack.pop_back();
@@ -231,6 +292,11 @@ const Painter::ShadowLayer& Painter::get_or_build_shadow_layer(int rect_w, int r
 }
 
 void Painter::draw_pixel(IntPoint point, Color color) {
+    if (m_recording) {
+        m_recording->draw_pixel(point, color);
+        return;
+    }
+
     if (m_global_alpha <= 0.0f) {
         return;
     }
@@ -250,7 +316,7 @@ void Painter::draw_pixel(IntPoint point, Color color) {
         return;
     }
 
-    if (!point_inside_rounded_clip(clip, m_current_clip.radius, x, y)) {
+    if (!point_inside_rounded_clip(m_current_clip.shape, m_current_clip.radius, x, y)) {
         return;
     }
 
@@ -260,8 +326,9 @@ void Painter::draw_pixel(IntPoint point, Color color) {
     }
 
     uint32_t* const pixels = m_canvas->pixels();
-    uint32_t& dst = pixels[y * canvas_w + x];
+    uint32_t& dst = pixels[y * m_canvas->stride() + x];
     const uint32_t src = color.as_argb();
+    count_writes(x, y, 1);
 
     if (alpha >= 255U) {
         dst = src;
@@ -271,6 +338,11 @@ void Painter::draw_pixel(IntPoint point, Color color) {
 }
 
 void Painter::fill_rect(const IntRect& rect, Color color) {
+    if (m_recording) {
+        m_recording->fill_rect(rect, color);
+        return;
+    }
+
     if (rect.w <= 0 || rect.h <= 0 || m_global_alpha <= 0.0f) {
         return;
     }
@@ -288,19 +360,20 @@ void Painter::fill_rect(const IntRect& rect, Color color) {
     }
 
     const uint32_t src = final_color.as_argb();
-    const int stride = m_canvas->width();
+    const int stride = m_canvas->stride();
     uint32_t* const pixels = m_canvas->pixels();
 
     if (m_current_clip.radius > 0) {
-        const IntRect& clip = m_current_clip.rect;
+        const IntRect& shape = m_current_clip.shape;
         const int radius = m_current_clip.radius;
 
         for (int y = dest.y; y < dest.bottom(); ++y) {
             uint32_t* row = pixels + y * stride;
             for (int x = dest.x; x < dest.right(); ++x) {
-                if (!point_inside_rounded_clip(clip, radius, x, y)) {
+                if (!point_inside_rounded_clip(shape, radius, x, y)) {
                     continue;
                 }
+                count_writes(x, y, 1);
 
                 uint32_t& dst = row[x];
                 if (alpha == 255U) {
@@ -317,12 +390,14 @@ void Painter::fill_rect(const IntRect& rect, Color color) {
         for (int y = 0; y < dest.h; ++y) {
             uint32_t* row = pixels + (dest.y + y) * stride + dest.x;
             std::fill_n(row, dest.w, src);
+            count_writes(dest.x, dest.y + y, dest.w);
         }
         return;
     }
 
     for (int y = 0; y < dest.h; ++y) {
         uint32_t* row = pixels + (dest.y + y) * stride + dest.x;
+        count_writes(dest.x, dest.y + y, dest.w);
         int x = 0;
 
         for (; x + 3 < dest.w; x += 4) {
@@ -338,10 +413,20 @@ void Painter::fill_rect(const IntRect& rect, Color color) {
 }
 
 void Painter::clear_rect(const IntRect& rect, Color color) {
+    if (m_recording) {
+        m_recording->clear_rect(rect, color);
+        return;
+    }
+
     fill_rect(rect, color);
 }
 
 void Painter::outline_rect(const IntRect& rect, Color color) {
+    if (m_recording) {
+        m_recording->outline_rect(rect, color);
+        return;
+    }
+
     if (rect.w <= 0 || rect.h <= 0) {
         return;
     }
@@ -353,6 +438,11 @@ void Painter::outline_rect(const IntRect& rect, Color color) {
 }
 
 void Painter::draw_line(IntPoint p1, IntPoint p2, Color color) {
+    if (m_recording) {
+        m_recording->draw_line(p1, p2, color);
+        return;
+    }
+
     int x1 = p1.x;
     int y1 = p1.y;
     const int x2 = p2.x;
@@ -383,6 +473,11 @@ void Painter::draw_line(IntPoint p1, IntPoint p2, Color color) {
 }
 
 void Painter::drop_shadow_rect(const IntRect& rect, int blur_radius, Color color, int roundness, IntPoint offset) {
+    if (m_recording) {
+        m_recording->drop_shadow_rect(rect, blur_radius, color, roundness, offset);
+        return;
+    }
+
     if (rect.w <= 0 || rect.h <= 0 || color.a == 0 || m_global_alpha <= 0.0f) {
         return;
     }
@@ -412,9 +507,9 @@ void Painter::drop_shadow_rect(const IntRect& rect, int blur_radius, Color color
     const uint32_t global_alpha = static_cast<uint32_t>(std::clamp(m_global_alpha, 0.0f, 1.0f) * 255.0f);
 
     uint32_t* pixels = m_canvas->pixels();
-    const int stride = m_canvas->width();
+    const int stride = m_canvas->stride();
 
-    const IntRect& clip = m_current_clip.rect;
+    const IntRect& clip_shape = m_current_clip.shape;
     const int clip_radius = m_current_clip.radius;
     const bool clip_is_rounded = clip_radius > 0;
 
@@ -426,7 +521,7 @@ void Painter::drop_shadow_rect(const IntRect& rect, int blur_radius, Color color
 
         for (int x = 0; x < clipped.w; ++x) {
             const int px = clipped.x + x;
-            if (clip_is_rounded && !point_inside_rounded_clip(clip, clip_radius, px, py)) {
+            if (clip_is_rounded && !point_inside_rounded_clip(clip_shape, clip_radius, px, py)) {
                 continue;
             }
 
@@ -442,6 +537,7 @@ void Painter::drop_shadow_rect(const IntRect& rect, int blur_radius, Color color
             }
 
             uint32_t& dst = dst_row[x];
+            count_writes(px, py, 1);
             if (alpha >= 255U) {
                 dst = source;
             } else {
@@ -497,6 +593,11 @@ static void draw_corner(Painter& painter, IntPoint center, int radius, int quad,
 }
 
 void Painter::fill_rounded_rect(const IntRect& rect, int radius, Color color, int corners) {
+    if (m_recording) {
+        m_recording->fill_rounded_rect(rect, radius, color, corners);
+        return;
+    }
+
     if (rect.w <= 0 || rect.h <= 0) {
         return;
     }
@@ -538,6 +639,11 @@ void Painter::fill_rounded_rect(const IntRect& rect, int radius, Color color, in
 }
 
 void Painter::draw_rounded_rect(const IntRect& rect, int radius, Color color, int thickness) {
+    if (m_recording) {
+        m_recording->draw_rounded_rect(rect, radius, color, thickness);
+        return;
+    }
+
     if (rect.w <= 0 || rect.h <= 0 || thickness <= 0) {
         return;
     }
@@ -564,6 +670,11 @@ void Painter::draw_rounded_rect(const IntRect& rect, int radius, Color color, in
 }
 
 void Painter::draw_blur_rect(const IntRect& rect, int blur_level) {
+    if (m_recording) {
+        m_recording->draw_blur_rect(rect, blur_level);
+        return;
+    }
+
     if (blur_level <= 0) {
         return;
     }
@@ -583,7 +694,7 @@ void Painter::draw_blur_rect(const IntRect& rect, int blur_level) {
 
     const int kernel_size = radius * 2 + 1;
     const int half = kernel_size / 2;
-    const int stride = m_canvas->width();
+    const int stride = m_canvas->stride();
     uint32_t* canvas_pixels = m_canvas->pixels();
 
     const size_t pixel_count = static_cast<size_t>(width) * static_cast<size_t>(height);
@@ -648,6 +759,7 @@ void Painter::draw_blur_rect(const IntRect& rect, int blur_level) {
         }
 
         for (int y = 0; y < height; ++y) {
+            count_writes(area.x + x, area.y + y, 1);
             canvas_pixels[(area.y + y) * stride + (area.x + x)] =
                 (static_cast<uint32_t>((sa + half) / kernel_size) << 24) |
                 (static_cast<uint32_t>((s2 + half) / kernel_size) << 16) |
@@ -10,6 +10,7 @@ namespace Izo {
 
 class Canvas;
 class Color;
+class DisplayList;
 
 class Painter {
    public:
@@ -22,7 +23,15 @@ class Painter {
     };
 
     Painter(std::unique_ptr<Canvas> canvas);
+    /* A painter without a canvas, everything drawn goes to the display list
+       set with set_recording(). Clips and transforms are tracked as usual,
+       so culling sees the same state as when drawing. */
+    Painter(int width, int height);
     void set_canvas(std::unique_ptr<Canvas> canvas);
+    void set_recording(DisplayList* list) { m_recording = list; }
+    DisplayList* recording() const { return m_recording; }
+    /* Size of a recording painter, follows the window */
+    void set_size(int width, int height);
     void push_clip(const IntRect& rect);
     void push_rounded_clip(const IntRect& rect, int radius);
     void pop_clip();
@@ -41,9 +50,26 @@ class Painter {
     void draw_blur_rect(const IntRect& rect, int blur_level);
 
     float global_alpha() const { return m_global_alpha; }
+    const IntRect& clip_rect() const { return m_current_clip.rect; }
+    IntPoint translation() const { return m_translation; }
     Canvas* canvas() { return m_canvas.get(); }
 
+    /* Overdraw accounting: counts the writes to every pixel since the last
+       reset_overdraw(), draw_overdraw_heatmap() visualizes the counts */
+    void set_overdraw_tracking(bool enabled);
+    bool overdraw_tracking() const { return !m_overdraw.empty(); }
+    void reset_overdraw();
+    void draw_overdraw_heatmap(const IntRect& rect);
+
    private:
+    void count_writes(int x, int y, int count) {
+        if (m_overdraw.empty()) return;
+        uint8_t* row = m_overdraw.data() + static_cast<size_t>(y) * m_overdraw_width + x;
+        for (int i = 0; i < count; ++i) {
+            if (row[i] < 255) ++row[i];
+        }
+    }
+
     IntRect apply_translate_to_rect(const IntRect& rect) const {
         return IntRect{
             rect.x + m_translation.x,
@@ -53,13 +79,21 @@ class Painter {
         };
     }
 
+    IntRect surface_rect() const;
+
     std::unique_ptr<Canvas> m_canvas;
+    DisplayList* m_recording = nullptr;
+    int m_width = 0;
+    int m_height = 0;
     IntPoint m_translation{0, 0};
     std::vector<IntPoint> m_translate_stack;
 
     struct ClipRect {
         IntRect rect;
         int radius = 0;
+        /* Unclipped rounded rect, corners are tested against this and not the
+           intersection so partial repaints keep the same shape */
+        IntRect shape;
     };
 
     struct ShadowLayer {
@@ -78,6 +112,8 @@ class Painter {
     std::vector<ClipRect> m_clip_stack;
     ShadowLayer m_shadow_layer_cache;
     float m_global_alpha = 1.0f;
+    std::vector<uint8_t> m_overdraw;
+    int m_overdraw_width = 0;
 };
 
 }  // namespace Izo
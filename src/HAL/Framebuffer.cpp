@@ -3,20 +3,32 @@
 #include <sys/mman.h>
 #include <sys/ioctl.h>
 #include <unistd.h>
+#include <algorithm>
 #include <cstring>
 #include <Debug/Logger.hpp>
 
 namespace Izo {
 
+// Past this many rects per buffer the damage collapses into its bounds
+static constexpr size_t kMaxDamageRects = 16;
+
+static IntRect rect_union(const IntRect& a, const IntRect& b) {
+    int x1 = std::min(a.x, b.x);
+    int y1 = std::min(a.y, b.y);
+    int x2 = std::max(a.right(), b.right());
+    int y2 = std::max(a.bottom(), b.bottom());
+    return {x1, y1, x2 - x1, y2 - y1};
+}
+
 Framebuffer::Framebuffer() 
-    : m_fd(-1), m_fbp(nullptr), m_width(0), m_height(0), m_double_buffered(false), m_current_buffer_idx(0) {
+    : m_fd(-1), m_fbp(nullptr), m_width(0), m_height(0), m_buffer_count(1), m_current_buffer_idx(0) {
 }
 
 Framebuffer::~Framebuffer() {
     cleanup();
 }
 
-bool Framebuffer::init(const std::string& device) {
+bool Framebuffer::init(const std::string& device, int buffers) {
     LogInfo("Initializing Framebuffer on {}", device);
 
     m_fd = open(device.c_str(), O_RDWR);
@@ -57,14 +69,34 @@ bool Framebuffer::init(const std::string& device) {
     m_bpp = m_vinfo.bits_per_pixel;
     m_line_length = m_finfo.line_length;
 
-    m_vinfo.yres_virtual = m_vinfo.yres * 2;
-    if (ioctl(m_fd, FBIOPUT_VSCREENINFO, &m_vinfo) == 0) {
-        ioctl(m_fd, FBIOGET_VSCREENINFO, &m_vinfo);
-        if (m_vinfo.yres_virtual >= m_vinfo.yres * 2) {
-             m_double_buffered = true;
-             LogInfo("Double buffering enabled");
+    for (int count = buffers; count >= 2 && m_buffer_count == 1; --count) {
+        m_vinfo.yres_virtual = m_vinfo.yres * count;
+        if (ioctl(m_fd, FBIOPUT_VSCREENINFO, &m_vinfo) == 0) {
+            ioctl(m_fd, FBIOGET_VSCREENINFO, &m_vinfo);
+            if (m_vinfo.yres_virtual >= m_vinfo.yres * count) {
+                m_buffer_count = count;
+                LogInfo("{} buffering enabled", count == 3 ? "Triple" : "Double");
+            }
         }
     }
+    if (m_buffer_count == 1) {
+        m_vinfo.yres_virtual = m_vinfo.yres;
+    }
+
+    m_direct_capable = m_buffer_count >= 2 && m_bpp == 32 && m_line_length % 4 == 0 &&
+                       m_vinfo.red.offset == 16 && m_vinfo.green.offset == 8 && m_vinfo.blue.offset == 0 &&
+                       m_vinfo.red.length == 8 && m_vinfo.green.length == 8 && m_vinfo.blue.length == 8;
+    if (m_direct_capable) {
+        LogInfo("Pixel format matches, frames can be drawn into the framebuffer directly");
+    }
+
+    m_flip_period = refresh_period();
+    if (m_flip_period == std::chrono::nanoseconds::zero()) {
+        m_flip_period = std::chrono::nanoseconds(16666667);
+    }
+
+    // Nothing was written to any buffer yet
+    m_buffer_damage.assign(m_buffer_count, {IntRect{0, 0, m_width, m_height}});
 
     m_screensize = m_vinfo.yres_virtual * m_finfo.line_length;
 
@@ -88,55 +120,123 @@ void Framebuffer::cleanup() {
     }
 }
 
+std::chrono::nanoseconds Framebuffer::refresh_period() const {
+    if (m_fd < 0 || m_vinfo.pixclock == 0) return std::chrono::nanoseconds::zero();
+
+    // pixclock is picoseconds per pixel, margins and sync are part of every line and frame
+    uint64_t htotal = m_vinfo.xres + m_vinfo.left_margin + m_vinfo.right_margin + m_vinfo.hsync_len;
+    uint64_t vtotal = m_vinfo.yres + m_vinfo.upper_margin + m_vinfo.lower_margin + m_vinfo.vsync_len;
+    return std::chrono::nanoseconds(static_cast<uint64_t>(m_vinfo.pixclock) * htotal * vtotal / 1000);
+}
+
+void Framebuffer::add_damage(std::vector<IntRect>& damage, const IntRect& rect) {
+    for (const auto& existing : damage) {
+        if (existing.contains(rect)) return;
+    }
+    std::erase_if(damage, [&](const IntRect& existing) { return rect.contains(existing); });
+    damage.push_back(rect);
+
+    if (damage.size() > kMaxDamageRects) {
+        IntRect bounds = damage.front();
+        for (const auto& existing : damage) bounds = rect_union(bounds, existing);
+        damage.assign(1, bounds);
+    }
+}
+
+void Framebuffer::copy_rect(const Canvas& src, uint8_t* dst_base, const IntRect& rect) {
+    for (int y = rect.y; y < rect.bottom(); ++y) {
+        uint32_t* dst_row = (uint32_t*)(dst_base + y * m_line_length);
+        std::memcpy(dst_row + rect.x, src.row(y) + rect.x, rect.w * 4);
+    }
+}
+
+bool Framebuffer::attach_back_buffer(Canvas& canvas) {
+    if (!m_fbp || !m_direct_capable) return false;
+
+    // The front buffer always holds the whole last frame, it brings the
+    // back buffer up to date where the frames since its last present drew
+    int buf_idx = (m_current_buffer_idx + 1) % m_buffer_count;
+    uint8_t* front = buffer_base(m_current_buffer_idx);
+    uint8_t* back = buffer_base(buf_idx);
+    for (const auto& rect : m_buffer_damage[buf_idx]) {
+        for (int y = rect.y; y < rect.bottom(); ++y) {
+            size_t offset = y * m_line_length + rect.x * 4;
+            std::memcpy(back + offset, front + offset, rect.w * 4);
+        }
+    }
+    m_buffer_damage[buf_idx].clear();
+
+    canvas.attach(reinterpret_cast<uint32_t*>(back), m_width, m_height, static_cast<int>(m_line_length / 4));
+    return true;
+}
+
 void Framebuffer::swap_buffers(Canvas& src, std::span<const IntRect> dirty_rects) {
     if (!m_fbp) return;
 
-    int buf_idx = m_double_buffered ? (1 - m_current_buffer_idx) : 0;
+    int buf_idx = (m_current_buffer_idx + 1) % m_buffer_count;
     int y_offset = buf_idx * m_height;
+    const IntRect screen{0, 0, m_width, m_height};
+    // Drawn in place after attach_back_buffer(), only the flip is left
+    const bool direct = reinterpret_cast<uint8_t*>(src.pixels()) == buffer_base(buf_idx);
 
-    if (m_bpp == 32) {
-        uint8_t* dst_base = m_fbp + (y_offset * m_line_length);
-        const uint32_t* src_pixels = src.pixels();
-
-        bool full_upload = dirty_rects.empty();
-        for (const auto& rect : dirty_rects) {
-            IntRect clipped = rect.intersection({0, 0, m_width, m_height});
-            if (clipped.w <= 0 || clipped.h <= 0) continue;
-            if (clipped.x == 0 && clipped.y == 0 && clipped.w == m_width && clipped.h == m_height) {
-                full_upload = true;
-                break;
-            }
+    m_frame_damage.clear();
+    if (dirty_rects.empty()) {
+        m_frame_damage.push_back(screen);
+    }
+    for (const auto& rect : dirty_rects) {
+        IntRect clipped = rect.intersection(screen);
+        if (clipped.w <= 0 || clipped.h <= 0) continue;
+        add_damage(m_frame_damage, clipped);
+    }
+
+    // The back buffer misses what the frames since its last present changed
+    std::vector<IntRect>& damage = m_buffer_damage[buf_idx];
+    if (!direct) {
+        for (const auto& rect : m_frame_damage) {
+            add_damage(damage, rect);
+        }
+    }
+    for (int i = 0; i < m_buffer_count; ++i) {
+        if (i == buf_idx) continue;
+        for (const auto& rect : m_frame_damage) {
+            add_damage(m_buffer_damage[i], rect);
         }
+    }
 
-        if (full_upload) {
-            for (int y = 0; y < m_height; ++y) {
-                uint32_t* dst_row = (uint32_t*)(dst_base + y * m_line_length);
-                const uint32_t* src_row = src_pixels + y * m_width;
-                std::memcpy(dst_row, src_row, m_width * 4);
-            }
-        } else {
-            for (const auto& rect : dirty_rects) {
-                IntRect clipped = rect.intersection({0, 0, m_width, m_height});
-                if (clipped.w <= 0 || clipped.h <= 0) continue;
-
-                for (int y = clipped.y; y < clipped.y + clipped.h; ++y) {
-                    uint32_t* dst_row = (uint32_t*)(dst_base + y * m_line_length);
-                    const uint32_t* src_row = src_pixels + y * m_width;
-                    std::memcpy(dst_row + clipped.x, src_row + clipped.x, clipped.w * 4);
-                }
-            }
+    if (!direct && m_bpp == 32) {
+        uint8_t* dst_base = buffer_base(buf_idx);
+        for (const auto& rect : damage) {
+            copy_rect(src, dst_base, rect);
         }
     }
+    damage.clear();
 
-    if (m_double_buffered) {
+    if (m_buffer_count == 2) {
         m_vinfo.yoffset = y_offset;
         ioctl(m_fd, FBIOPAN_DISPLAY, &m_vinfo);
 
         int arg = 0;
-        ioctl(m_fd, FBIO_WAITFORVSYNC, &arg);
-
-        m_current_buffer_idx = buf_idx;
+        if (ioctl(m_fd, FBIO_WAITFORVSYNC, &arg) == 0) {
+            m_last_vsync = std::chrono::steady_clock::now();
+        }
+    } else if (m_buffer_count == 3) {
+        // The buffer just written was neither on screen nor queued, so the
+        // copy ran while the previous flip was still pending. Panning twice
+        // within one refresh would drop that frame though, so wait for the
+        // vsync unless a whole period went by since the last pan.
+        auto now = std::chrono::steady_clock::now();
+        int arg = 0;
+        if (m_flip_pending && now - m_last_pan < m_flip_period &&
+            ioctl(m_fd, FBIO_WAITFORVSYNC, &arg) == 0) {
+            m_last_vsync = std::chrono::steady_clock::now();
+        }
+        m_vinfo.yoffset = y_offset;
+        ioctl(m_fd, FBIOPAN_DISPLAY, &m_vinfo);
+        m_last_pan = std::chrono::steady_clock::now();
+        m_flip_pending = true;
     }
+
+    m_current_buffer_idx = buf_idx;
 }
 
-} 
+}
@@ -2,8 +2,10 @@
 
 #include "Graphics/Canvas.hpp"
 
+#include <chrono>
 #include <string>
 #include <span>
+#include <vector>
 #include <linux/fb.h>
 
 namespace Izo {
@@ -13,18 +15,38 @@ public:
     Framebuffer();
     ~Framebuffer();
 
-    bool init(const std::string& device = "/dev/graphics/fb0");
+    /* buffers is 2 for double or 3 for triple buffering, fewer are used if
+       the virtual resolution can't hold them */
+    bool init(const std::string& device = "/dev/graphics/fb0", int buffers = 2);
     void cleanup();
 
     void swap_buffers(Canvas& src, std::span<const IntRect> dirty_rects = {});
+    /* Zero-copy presenting: points canvas at the buffer the next frame
+       goes to, already holding what is on screen, and swap_buffers() with
+       that canvas only flips. False if the buffers can't be drawn into.
+       Once used, later presents from another canvas must cover the screen. */
+    bool attach_back_buffer(Canvas& canvas);
 
     int width() const { return m_width; }
     int height() const { return m_height; }
     bool valid() const { return m_fd > 0; }
 
+    /* From the mode timings, zero if the driver leaves them out */
+    std::chrono::nanoseconds refresh_period() const;
+    /* When the last swap_buffers() went out, unknown without page flipping.
+       Triple buffering does not wait for the flip, so it is unknown there too. */
+    std::chrono::steady_clock::time_point last_vsync() const {
+        return m_buffer_count == 2 ? m_last_vsync : std::chrono::steady_clock::time_point{};
+    }
+
     uint32_t* buffer() { return (uint32_t*)m_fbp; }
 
 private:
+    /* Adds rect to a damage list, dropping rects it covers */
+    static void add_damage(std::vector<IntRect>& damage, const IntRect& rect);
+    void copy_rect(const Canvas& src, uint8_t* dst_base, const IntRect& rect);
+    uint8_t* buffer_base(int index) { return m_fbp + static_cast<size_t>(index) * m_height * m_line_length; }
+
     int m_fd;
     uint8_t* m_fbp;
     size_t m_screensize;
@@ -35,8 +57,20 @@ private:
     struct fb_var_screeninfo m_vinfo;
     struct fb_fix_screeninfo m_finfo;
 
-    bool m_double_buffered;
+    int m_buffer_count;
+    // ARGB8888 with page flipping, the engine can draw into the buffers
+    bool m_direct_capable = false;
     int m_current_buffer_idx;
+    // Per buffer, everything presented since it was last written. A buffer
+    // gets this plus the new frame's damage before it is shown again.
+    std::vector<std::vector<IntRect>> m_buffer_damage;
+    std::vector<IntRect> m_frame_damage;
+    // Triple buffering: the last pan may not have reached the display yet,
+    // it has for sure once a refresh period passed
+    bool m_flip_pending = false;
+    std::chrono::steady_clock::time_point m_last_pan{};
+    std::chrono::nanoseconds m_flip_period{0};
+    std::chrono::steady_clock::time_point m_last_vsync{};
 };
 
 } 
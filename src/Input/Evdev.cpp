@@ -0,0 +1,436 @@
+#include "Evdev.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#include "Core/File.hpp"
+#include "Debug/Logger.hpp"
+#include "Input.hpp"
+
+namespace Izo {
+
+static constexpr const char* kInputDir = "/dev/input";
+
+static uint64_t event_time_ns(const input_event& event) {
+    return static_cast<uint64_t>(event.input_event_sec) * 1000000000ull +
+           static_cast<uint64_t>(event.input_event_usec) * 1000ull;
+}
+
+static KeyCode linux_code_to_ascii(int code, bool shift) {
+    // Letter codes follow the keyboard rows, not the alphabet
+    static constexpr struct {
+        int first;
+        const char* letters;
+    } kRows[] = {{KEY_Q, "qwertyuiop"}, {KEY_A, "asdfghjkl"}, {KEY_Z, "zxcvbnm"}};
+    for (const auto& row : kRows) {
+        int index = code - row.first;
+        if (index >= 0 && index < static_cast<int>(std::strlen(row.letters))) {
+            int val = row.letters[index];
+            if (shift) val -= 32;
+            return (KeyCode)val;
+        }
+    }
+    if (code >= KEY_1 && code <= KEY_9) {
+        if (!shift) return (KeyCode)('1' + (code - KEY_1));
+        const char* syms = "!@#$%^&*(";
+        return (KeyCode)syms[code - KEY_1];
+    }
+    if (code == KEY_0) return shift ? (KeyCode)')' : (KeyCode)'0';
+    if (code == KEY_SPACE) return KeyCode::Space;
+    if (code == KEY_ENTER) return KeyCode::Enter;
+    if (code == KEY_BACKSPACE) return KeyCode::Backspace;
+    return KeyCode::None;
+}
+
+static bool test_bit(const unsigned char* bits, int bit) {
+    return bits[bit / 8] & (1 << (bit % 8));
+}
+
+void EvdevDecoder::feed(const input_event& event, uint64_t timestamp_ns) {
+    // Everything up to the next SYN_REPORT is incomplete after a drop
+    if (m_dropping) {
+        if (event.type == EV_SYN && event.code == SYN_REPORT) {
+            m_dropping = false;
+            m_needs_resync = true;
+        }
+        return;
+    }
+
+    switch (event.type) {
+        case EV_SYN:
+            if (event.code == SYN_REPORT) {
+                flush(timestamp_ns);
+            } else if (event.code == SYN_DROPPED) {
+                LogWarn("Evdev: Kernel buffer overrun, resyncing");
+                m_dropping = true;
+                m_pending_keys.clear();
+            }
+            break;
+        case EV_KEY:
+            if (event.code == BTN_TOUCH || event.code == BTN_LEFT) {
+                // Multitouch devices report contacts through tracking ids
+                if (!m_multitouch) m_down = event.value != 0;
+                m_pointer_changed = true;
+            } else {
+                m_pending_keys.push_back({event.code, event.value});
+            }
+            break;
+        case EV_ABS: {
+            m_pointer_changed = true;
+            Slot* slot = (m_slot >= 0 && m_slot < kMaxSlots) ? &m_slots[m_slot] : nullptr;
+            switch (event.code) {
+                case ABS_MT_SLOT:
+                    m_multitouch = true;
+                    m_slot = event.value;
+                    break;
+                case ABS_MT_TRACKING_ID:
+                    m_multitouch = true;
+                    if (slot) {
+                        if (m_slot == m_primary) m_primary_lifted = true;
+                        slot->tracking_id = event.value;
+                    }
+                    break;
+                case ABS_MT_POSITION_X:
+                    m_multitouch = true;
+                    if (slot) slot->x = event.value;
+                    break;
+                case ABS_MT_POSITION_Y:
+                    m_multitouch = true;
+                    if (slot) slot->y = event.value;
+                    break;
+                case ABS_X:
+                    m_x = event.value;
+                    break;
+                case ABS_Y:
+                    m_y = event.value;
+                    break;
+            }
+            break;
+        }
+    }
+}
+
+void EvdevDecoder::flush(uint64_t timestamp_ns) {
+    Input& input = Input::the();
+
+    for (const PendingKey& key : m_pending_keys) {
+        if (key.code == KEY_LEFTSHIFT || key.code == KEY_RIGHTSHIFT) {
+            m_shift = key.value != 0;
+            input.push_shift(m_shift, timestamp_ns);
+        } else if (key.code == KEY_LEFTCTRL || key.code == KEY_RIGHTCTRL) {
+            input.push_ctrl(key.value != 0, timestamp_ns);
+        } else if (key.value == 1 || key.value == 2) {
+            KeyCode code = linux_code_to_ascii(key.code, m_shift);
+            if (code != KeyCode::None) {
+                input.push_key(code, timestamp_ns);
+            }
+        }
+    }
+    m_pending_keys.clear();
+
+    // A key frame must not move or release the pointer of another device
+    if (!m_pointer_changed) return;
+    m_pointer_changed = false;
+
+    if (!m_multitouch) {
+        input.push_touch({m_x, m_y}, m_down, timestamp_ns);
+        return;
+    }
+
+    if (m_primary >= 0 && m_primary_lifted) {
+        const Slot& primary = m_slots[m_primary];
+        input.push_touch({primary.x, primary.y}, false, timestamp_ns);
+        m_primary = -1;
+        // The other fingers of a gesture must not start a new press
+        m_wait_for_release = true;
+    }
+    m_primary_lifted = false;
+
+    bool any_contact = false;
+    for (int i = 0; i < kMaxSlots; ++i) {
+        if (m_slots[i].tracking_id == -1) continue;
+        any_contact = true;
+        if (m_primary < 0 && !m_wait_for_release) m_primary = i;
+    }
+    if (!any_contact) m_wait_for_release = false;
+
+    if (m_primary >= 0) {
+        const Slot& primary = m_slots[m_primary];
+        input.push_touch({primary.x, primary.y}, true, timestamp_ns);
+    }
+}
+
+void EvdevDecoder::resync_slot(int slot, int tracking_id, int x, int y) {
+    if (slot < 0 || slot >= kMaxSlots) return;
+    if (slot == m_primary && m_slots[slot].tracking_id != tracking_id) m_primary_lifted = true;
+    m_slots[slot] = {tracking_id, x, y};
+    m_pointer_changed = true;
+}
+
+void EvdevDecoder::finish_resync(uint64_t timestamp_ns) {
+    m_needs_resync = false;
+    flush(timestamp_ns);
+}
+
+EvdevReader::~EvdevReader() {
+    stop();
+}
+
+void EvdevReader::start() {
+    if (m_running) return;
+
+    m_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    m_wake_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (m_epoll_fd < 0 || m_wake_fd < 0) {
+        LogError("Evdev: Failed to create epoll or eventfd");
+        return;
+    }
+
+    epoll_event wake{};
+    wake.events = EPOLLIN;
+    wake.data.fd = m_wake_fd;
+    epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, m_wake_fd, &wake);
+
+    m_running = true;
+    m_thread = std::thread(&EvdevReader::run_thread, this);
+}
+
+void EvdevReader::stop() {
+    if (!m_running) return;
+
+    m_running = false;
+    uint64_t one = 1;
+    [[maybe_unused]] auto written = write(m_wake_fd, &one, sizeof(one));
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+
+    while (!m_devices.empty()) {
+        close_device(m_devices.begin()->first);
+    }
+    if (m_inotify_fd >= 0) close(m_inotify_fd);
+    close(m_wake_fd);
+    close(m_epoll_fd);
+    m_inotify_fd = m_wake_fd = m_epoll_fd = -1;
+}
+
+void EvdevReader::open_device(const std::string& path) {
+    for (const auto& [fd, device] : m_devices) {
+        if (device.path == path) return;
+    }
+
+    // Nodes of hotplugged devices may not be readable yet, IN_ATTRIB retries
+    int fd = open(path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) return;
+
+    unsigned char evtype_b[EV_MAX / 8 + 1] = {};
+    ioctl(fd, EVIOCGBIT(0, sizeof(evtype_b)), evtype_b);
+
+    bool keep = false;
+    if (test_bit(evtype_b, EV_ABS)) {
+        unsigned char abs_b[ABS_MAX / 8 + 1] = {};
+        ioctl(fd, EVIOCGBIT(EV_ABS, sizeof(abs_b)), abs_b);
+        if (test_bit(abs_b, ABS_MT_POSITION_X)) {
+            keep = true;
+            LogInfo("Input '{}' is a Touchscreen", path);
+        }
+    }
+
+    if (!keep && test_bit(evtype_b, EV_KEY)) {
+        unsigned char key_b[KEY_MAX / 8 + 1] = {};
+        ioctl(fd, EVIOCGBIT(EV_KEY, sizeof(key_b)), key_b);
+        if (test_bit(key_b, KEY_ENTER)) {
+            keep = true;
+            LogInfo("Input '{}' is a Keyboard", path);
+        }
+    }
+
+    if (!keep) {
+        close(fd);
+        return;
+    }
+
+    // Same clock as Input::now_ns(), the default is CLOCK_REALTIME
+    int clock = CLOCK_MONOTONIC;
+    ioctl(fd, EVIOCSCLOCKID, &clock);
+
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    if (epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0) {
+        close(fd);
+        return;
+    }
+    m_devices[fd].path = path;
+}
+
+void EvdevReader::close_device(int fd) {
+    auto it = m_devices.find(fd);
+    if (it == m_devices.end()) return;
+
+    LogInfo("Input '{}' removed", it->second.path);
+    epoll_ctl(m_epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+    close(fd);
+    m_devices.erase(it);
+}
+
+void EvdevReader::resync(int fd, Device& device) {
+    struct {
+        uint32_t code;
+        int32_t values[EvdevDecoder::kMaxSlots];
+    } ids{ABS_MT_TRACKING_ID, {}}, xs{ABS_MT_POSITION_X, {}}, ys{ABS_MT_POSITION_Y, {}};
+
+    if (ioctl(fd, EVIOCGMTSLOTS(sizeof(ids)), &ids) < 0 ||
+        ioctl(fd, EVIOCGMTSLOTS(sizeof(xs)), &xs) < 0 ||
+        ioctl(fd, EVIOCGMTSLOTS(sizeof(ys)), &ys) < 0) {
+        // Not a multitouch device, the next frame carries the full state
+        device.decoder.finish_resync(Input::now_ns());
+        return;
+    }
+
+    for (int slot = 0; slot < EvdevDecoder::kMaxSlots; ++slot) {
+        device.decoder.resync_slot(slot, ids.values[slot], xs.values[slot], ys.values[slot]);
+    }
+    device.decoder.finish_resync(Input::now_ns());
+}
+
+void EvdevReader::read_device(int fd) {
+    // Closed earlier in this epoll batch, e.g. by an IN_DELETE
+    auto it = m_devices.find(fd);
+    if (it == m_devices.end()) return;
+    Device& device = it->second;
+
+    input_event events[64];
+    while (true) {
+        ssize_t len = read(fd, events, sizeof(events));
+        if (len < 0) {
+            if (errno == EAGAIN || errno == EINTR) return;
+            // ENODEV once the device is gone
+            close_device(fd);
+            return;
+        }
+        if (len == 0) return;
+
+        size_t count = static_cast<size_t>(len) / sizeof(input_event);
+        for (size_t i = 0; i < count; ++i) {
+            device.decoder.feed(events[i], event_time_ns(events[i]));
+            if (device.decoder.needs_resync()) {
+                resync(fd, device);
+            }
+        }
+    }
+}
+
+void EvdevReader::run_thread() {
+    LogInfo("Starting evdev input thread");
+
+    m_inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_inotify_fd >= 0 && inotify_add_watch(m_inotify_fd, kInputDir, IN_CREATE | IN_ATTRIB | IN_DELETE) >= 0) {
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = m_inotify_fd;
+        epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, m_inotify_fd, &event);
+    } else {
+        LogWarn("Evdev: Unable to watch '{}', hotplugged devices are ignored", kInputDir);
+    }
+
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(kInputDir, ec)) {
+        if (entry.path().filename().string().starts_with("event")) {
+            open_device(entry.path().string());
+        }
+    }
+    if (m_devices.empty()) {
+        LogWarn("No input devices found yet, waiting for hotplug");
+    }
+
+    alignas(struct inotify_event) char buffer[4096];
+    epoll_event ready[16];
+    while (m_running) {
+        int count = epoll_wait(m_epoll_fd, ready, 16, -1);
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+
+        for (int i = 0; i < count && m_running; ++i) {
+            int fd = ready[i].data.fd;
+            if (fd == m_wake_fd) continue;
+
+            if (fd == m_inotify_fd) {
+                ssize_t len;
+                while ((len = read(m_inotify_fd, buffer, sizeof(buffer))) > 0) {
+                    for (char* ptr = buffer; ptr < buffer + len;) {
+                        auto* event = reinterpret_cast<inotify_event*>(ptr);
+                        ptr += sizeof(inotify_event) + event->len;
+                        if (event->len == 0 || !std::string_view(event->name).starts_with("event")) continue;
+
+                        std::string path = std::string(kInputDir) + "/" + event->name;
+                        if (event->mask & IN_DELETE) {
+                            for (const auto& [device_fd, device] : m_devices) {
+                                if (device.path == path) {
+                                    close_device(device_fd);
+                                    break;
+                                }
+                            }
+                        } else {
+                            open_device(path);
+                        }
+                    }
+                }
+                continue;
+            }
+
+            if (ready[i].events & (EPOLLERR | EPOLLHUP)) {
+                close_device(fd);
+            } else {
+                read_device(fd);
+            }
+        }
+    }
+
+    LogInfo("Input thread stopped");
+}
+
+bool replay_evdev_recording(const std::string& path, bool realtime, const std::atomic<bool>& running) {
+    MappedFile file = File::map(path, MappedFile::Access::Sequential);
+    if (!file.valid() || file.size() % sizeof(input_event) != 0) {
+        LogError("Evdev: '{}' is not a recording of input_event records", path);
+        return false;
+    }
+
+    const size_t count = file.size() / sizeof(input_event);
+    if (count == 0) {
+        LogError("Evdev: '{}' holds no events", path);
+        return false;
+    }
+    std::vector<input_event> events(count);
+    std::memcpy(events.data(), file.data(), file.size());
+
+    // Recorded timestamps are moved to now, keeping their spacing
+    EvdevDecoder decoder;
+    const uint64_t first_ns = event_time_ns(events.front());
+    const uint64_t start_ns = Input::now_ns();
+    const auto start = std::chrono::steady_clock::now();
+    for (const input_event& event : events) {
+        if (!running) return false;
+
+        uint64_t offset_ns = event_time_ns(event) - first_ns;
+        if (realtime) {
+            std::this_thread::sleep_until(start + std::chrono::nanoseconds(offset_ns));
+        }
+        decoder.feed(event, start_ns + offset_ns);
+    }
+
+    LogInfo("Evdev: Replayed {} events from '{}'", count, path);
+    return true;
+}
+
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+#include <linux/input.h>
+
+#include "KeyCode.hpp"
+
+namespace Izo {
+
+/* Turns the event stream of one evdev device into Input events. Everything
+   between two SYN_REPORTs is one frame and is pushed at once with the
+   kernel timestamp of the frame. Multitouch devices are decoded slot by
+   slot (protocol B); the UI has a single pointer, which follows the first
+   contact until it lifts. */
+class EvdevDecoder {
+public:
+    static constexpr int kMaxSlots = 16;
+
+    void feed(const input_event& event, uint64_t timestamp_ns);
+
+    /* After SYN_DROPPED the slot state is stale until resync_slot() was
+       called for every slot, see EvdevReader */
+    bool needs_resync() const { return m_needs_resync; }
+    void resync_slot(int slot, int tracking_id, int x, int y);
+    void finish_resync(uint64_t timestamp_ns);
+
+private:
+    struct Slot {
+        int tracking_id = -1;
+        int x = 0;
+        int y = 0;
+    };
+
+    struct PendingKey {
+        int code;
+        int value;
+    };
+
+    void flush(uint64_t timestamp_ns);
+
+    std::array<Slot, kMaxSlots> m_slots;
+    int m_slot = 0;
+    bool m_multitouch = false;
+    int m_primary = -1;
+    bool m_primary_lifted = false;
+    bool m_wait_for_release = false;
+    // Touch or pointer events in the current frame, keyboards never set it
+    bool m_pointer_changed = false;
+
+    // Single touch devices and mice with absolute coordinates
+    int m_x = 0;
+    int m_y = 0;
+    bool m_down = false;
+
+    std::vector<PendingKey> m_pending_keys;
+    bool m_shift = false;
+    bool m_dropping = false;
+    bool m_needs_resync = false;
+};
+
+/* Reads every touchscreen and keyboard below /dev/input from one epoll
+   loop. inotify on the directory picks up devices plugged in later. */
+class EvdevReader {
+public:
+    ~EvdevReader();
+
+    void start();
+    void stop();
+    bool running() const { return m_running; }
+
+private:
+    struct Device {
+        std::string path;
+        EvdevDecoder decoder;
+    };
+
+    void run_thread();
+    void open_device(const std::string& path);
+    void close_device(int fd);
+    void read_device(int fd);
+    void resync(int fd, Device& device);
+
+    int m_epoll_fd = -1;
+    int m_inotify_fd = -1;
+    int m_wake_fd = -1;
+    std::map<int, Device> m_devices;
+
+    std::atomic<bool> m_running{false};
+    std::thread m_thread;
+};
+
+/* Feeds a recorded evdev stream through an EvdevDecoder. Recordings are the
+   raw input_event records of a device, e.g. `cat /dev/input/event2 > tap.evdev`.
+   With realtime set, the original spacing of the events is kept. */
+bool replay_evdev_recording(const std::string& path, bool realtime, const std::atomic<bool>& running);
+
+}
@@ -1,18 +1,13 @@
 #include "Input.hpp"
+#include <Core/Application.hpp>
+#include <Core/Settings.hpp>
 #include <Debug/Logger.hpp>
-#include <fcntl.h>
-#include <unistd.h>
-
-#ifdef __ANDROID__
-#include <cstring>
-#include <format>
-#include <sys/poll.h>
-#include <linux/input.h>
-#include <sys/ioctl.h>
-#endif
+#include <ctime>
 
 namespace Izo {
 
+static thread_local bool t_replay_thread = false;
+
 Input& Input::the() {
     static Input g_instance;
     return g_instance;
@@ -22,213 +17,157 @@ Input::Input() {
 }
 
 Input::~Input() {
-    if (m_running) {
-        m_running = false;
-        if (m_worker_thread.joinable()) {
-            m_worker_thread.join();
-        }
+    m_replaying = false;
+    if (m_replay_thread.joinable()) {
+        m_replay_thread.join();
     }
+    m_reader.stop();
 }
 
-void Input::set_touch(IntPoint point, bool down) {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    m_state.touch_point = point;
-    m_state.touch_down = down;
+uint64_t Input::now_ns() {
+    timespec ts{};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
 }
 
-void Input::set_key(KeyCode key) {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    m_state.last_key = key;
+bool Input::accepts_producer() const {
+    return !m_replaying.load(std::memory_order_acquire) || t_replay_thread;
 }
 
-void Input::set_shift(bool down) {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    m_state.shift_down = down;
+void Input::push(InputEvent event, uint64_t timestamp_ns) {
+    event.timestamp_ns = timestamp_ns ? timestamp_ns : now_ns();
+    event.shift = m_producer_shift;
+    event.ctrl = m_producer_ctrl;
+    m_queue.push(event);
+    Application::wake();
 }
 
-void Input::set_ctrl(bool down) {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    m_state.ctrl_down = down;
+void Input::push_touch(IntPoint point, bool down, uint64_t timestamp_ns) {
+    std::lock_guard<std::mutex> lock(m_producer_mutex);
+    if (!accepts_producer()) return;
+
+    InputEventType type = InputEventType::TouchMove;
+    if (down && !m_producer_down) {
+        type = InputEventType::TouchDown;
+    } else if (!down && m_producer_down) {
+        type = InputEventType::TouchUp;
+    } else if (point == m_producer_point) {
+        return;
+    }
+
+    m_producer_point = point;
+    m_producer_down = down;
+    push({.type = type, .point = point, .down = down}, timestamp_ns);
 }
 
-void Input::set_scroll(int y) {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    m_state.scroll_y += y;
+void Input::push_key(KeyCode key, uint64_t timestamp_ns) {
+    std::lock_guard<std::mutex> lock(m_producer_mutex);
+    if (!accepts_producer()) return;
+    push({.type = InputEventType::Key, .key = key}, timestamp_ns);
 }
 
-KeyCode Input::key() {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    KeyCode key = m_state.last_key;
-    m_state.last_key = KeyCode::None;
-    return key;
+void Input::push_shift(bool down, uint64_t timestamp_ns) {
+    std::lock_guard<std::mutex> lock(m_producer_mutex);
+    if (!accepts_producer()) return;
+    if (m_producer_shift == down) return;
+    m_producer_shift = down;
+    push({.type = InputEventType::Modifiers}, timestamp_ns);
 }
 
-IntPoint Input::touch_point() {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    return m_state.touch_point;
+void Input::push_ctrl(bool down, uint64_t timestamp_ns) {
+    std::lock_guard<std::mutex> lock(m_producer_mutex);
+    if (!accepts_producer()) return;
+    if (m_producer_ctrl == down) return;
+    m_producer_ctrl = down;
+    push({.type = InputEventType::Modifiers}, timestamp_ns);
 }
 
-bool Input::touch_down() {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    return m_state.touch_down;
+void Input::push_scroll(int y, uint64_t timestamp_ns) {
+    if (y == 0) return;
+    std::lock_guard<std::mutex> lock(m_producer_mutex);
+    if (!accepts_producer()) return;
+    push({.type = InputEventType::Scroll, .scroll = y}, timestamp_ns);
 }
 
-bool Input::shift() {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    return m_state.shift_down;
+void Input::poll_events() {
+    m_drained.clear();
+    m_queue.drain(m_drained);
+
+    const bool coalesce = Settings::coalesce_touch_moves.get();
+    for (const InputEvent& event : m_drained) {
+        // Only the last of a run of moves matters for hit testing and
+        // dragging, downs, ups and everything else are always kept
+        if (coalesce && event.type == InputEventType::TouchMove && !m_pending.empty() &&
+            m_pending.back().type == InputEventType::TouchMove && m_pending.back().down == event.down) {
+            m_pending.back() = event;
+            continue;
+        }
+        m_pending.push_back(event);
+    }
 }
 
-bool Input::ctrl() {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    return m_state.ctrl_down;
+bool Input::next_event(InputEvent& event) {
+    if (m_pending.empty()) return false;
+    event = m_pending.front();
+    m_pending.pop_front();
+
+    m_state.shift_down = event.shift;
+    m_state.ctrl_down = event.ctrl;
+    switch (event.type) {
+        case InputEventType::TouchDown:
+        case InputEventType::TouchMove:
+        case InputEventType::TouchUp:
+            m_state.touch_point = event.point;
+            m_state.touch_down = event.down;
+            break;
+        case InputEventType::Scroll:
+            m_state.scroll_y += event.scroll;
+            break;
+        case InputEventType::Key:
+        case InputEventType::Modifiers:
+            break;
+    }
+    return true;
 }
 
 int Input::scroll_y() {
-    std::lock_guard<std::mutex> lock(m_mutex);
     int y = m_state.scroll_y;
     m_state.scroll_y = 0;
     return y;
 }
 
-int Input::peek_scroll_y() {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    return m_state.scroll_y;
-}
-
+void Input::init() {
 #ifdef __ANDROID__
-static KeyCode linux_code_to_ascii(int code, bool shift) {
-    if (code >= KEY_A && code <= KEY_Z) {
-        int val = 'a' + (code - KEY_A);
-        if (shift) val -= 32;
-        return (KeyCode)val;
-    }
-    if (code >= KEY_1 && code <= KEY_9) {
-        if (!shift) return (KeyCode)('1' + (code - KEY_1));
-        const char* syms = "!@#$%^&*(";
-        return (KeyCode)syms[code - KEY_1];
-    }
-    if (code == KEY_0) return shift ? (KeyCode)')' : (KeyCode)'0';
-    if (code == KEY_SPACE) return KeyCode::Space;
-    if (code == KEY_ENTER) return KeyCode::Enter;
-    if (code == KEY_BACKSPACE) return KeyCode::Backspace;
-    return KeyCode::None; 
-}
+    m_reader.start();
 #endif
+}
 
-void Input::run_thread() {
-#ifdef __ANDROID__
-    LogInfo("Starting Android Input Thread");
-
-    struct pollfd fds[16];
-    int count = 0;
-
-    for (int i = 0; i < 10; i++) {
-        std::string path = std::format("/dev/input/event{}", std::to_string(i));
-
-        int fd = open(path.c_str(), O_RDONLY);
-        if (fd >= 0) {
-            unsigned char evtype_b[EV_MAX/8 + 1];
-            memset(evtype_b, 0, sizeof(evtype_b));
-            ioctl(fd, EVIOCGBIT(0, sizeof(evtype_b)), evtype_b);
-
-            bool keep = false;
-
-            if ((evtype_b[EV_ABS/8] & (1<<(EV_ABS%8)))) {
-                unsigned char abs_b[ABS_MAX/8 + 1];
-                ioctl(fd, EVIOCGBIT(EV_ABS, sizeof(abs_b)), abs_b);
-                if (abs_b[ABS_MT_POSITION_X/8] & (1<<(ABS_MT_POSITION_X%8))) {
-                    keep = true;
-                    LogInfo("Input '{}' is a Touchscreen", path);
-                }
-            }
-
-            if (!keep && (evtype_b[EV_KEY/8] & (1<<(EV_KEY%8)))) {
-                 unsigned char key_b[KEY_MAX/8 + 1];
-                 ioctl(fd, EVIOCGBIT(EV_KEY, sizeof(key_b)), key_b);
-                 if (key_b[KEY_ENTER/8] & (1<<(KEY_ENTER%8))) {
-                     keep = true;
-                     LogInfo("Input '{}' is a Keyboard", path);
-                 }
-            }
-
-            if (keep) {
-                fds[count].fd = fd;
-                fds[count].events = POLLIN;
-                count++;
-            } else {
-                close(fd);
-            }
-        }
+void Input::start_replay(const std::string& path) {
+    if (m_replaying) return;
+    if (m_replay_thread.joinable()) {
+        m_replay_thread.join();
     }
 
-    if (count == 0) {
-        LogError("No input devices found!");
-        return;
+    // The replay is the only producer while it runs. Taking the producer
+    // lock waits out a push that already passed the check, and the device
+    // reader stays stopped until the replay is over.
+    bool reader_was_running = m_reader.running();
+    m_reader.stop();
+    {
+        std::lock_guard<std::mutex> lock(m_producer_mutex);
+        m_replaying = true;
     }
-
-    struct input_event ev;
-    bool shift = false;
-    int lx = 0, ly = 0; 
-    bool ldown = false;
-
-    while (m_running) {
-        int ret = poll(fds, count, 100); 
-        if (ret == 0) continue; 
-        if (ret < 0) break; 
-
-        bool touch_updated = false;
-
-        for (int i = 0; i < count; i++) {
-            if (fds[i].revents & POLLIN) {
-                if (read(fds[i].fd, &ev, sizeof(struct input_event)) > 0) {
-                    if (ev.type == EV_KEY) {
-                        if (ev.code == KEY_LEFTSHIFT || ev.code == KEY_RIGHTSHIFT) {
-                            shift = (ev.value != 0);
-                            set_shift(shift);
-                        } else if (ev.code == BTN_TOUCH || ev.code == BTN_LEFT) {
-                            ldown = (ev.value != 0);
-                            touch_updated = true;
-                        } else if (ev.value == 1 || ev.value == 2) { 
-                            KeyCode key = linux_code_to_ascii(ev.code, shift);
-                            if (key != KeyCode::None) {
-                                set_key(key);
-                            }
-                        }
-                    } else if (ev.type == EV_ABS) {
-                        if (ev.code == ABS_MT_POSITION_X || ev.code == ABS_X) {
-                            lx = ev.value;
-                            touch_updated = true;
-                        } else if (ev.code == ABS_MT_POSITION_Y || ev.code == ABS_Y) {
-                            ly = ev.value;
-                            touch_updated = true;
-                        } else if (ev.code == ABS_MT_TRACKING_ID) {
-                            ldown = (ev.value != -1);
-                            touch_updated = true;
-                        }
-                    }
-                }
-            }
-        }
-
-        if (touch_updated) {
-            set_touch(IntPoint(lx, ly), ldown);
+    m_replay_thread = std::thread([this, path, reader_was_running]() {
+        t_replay_thread = true;
+        replay_evdev_recording(path, true, m_replaying);
+        t_replay_thread = false;
+        {
+            std::lock_guard<std::mutex> lock(m_producer_mutex);
+            if (!m_replaying) return;  // shutting down
+            m_replaying = false;
         }
-    }
-
-    for (int i = 0; i < count; i++) {
-        close(fds[i].fd);
-    }
-    LogInfo("Input thread stopped");
-#endif
-}
-
-void Input::init() {
-#ifdef __ANDROID__
-    if (!m_running) {
-        m_running = true;
-        m_worker_thread = std::thread(&Input::run_thread, this);
-    }
-#endif
+        if (reader_was_running) m_reader.start();
+    });
 }
 
 void Input::update() {
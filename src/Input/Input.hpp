@@ -1,23 +1,30 @@
 #pragma once
 
 #include <atomic>
+#include <deque>
 #include <mutex>
+#include <string>
 #include <thread>
+#include <vector>
+#include "Evdev.hpp"
 #include "Geometry/Primitives.hpp"
+#include "InputQueue.hpp"
 #include "KeyCode.hpp"
 
 namespace Izo {
 
+/* State as of the last event handed out by next_event() */
 struct InputState {
     IntPoint touch_point = {0, 0};
     bool touch_down = false;
     bool shift_down = false;
     bool ctrl_down = false;
     int scroll_y = 0;
-
-    KeyCode last_key = KeyCode::None;
 };
 
+/* Platform readers push events from their own thread, the UI thread takes
+   them once per frame with poll_events() and next_event(). Getters reflect
+   the events handed out so far and are UI thread only. */
 class Input {
 public:
     static Input& the();
@@ -25,32 +32,58 @@ public:
     void init();
     void update();
 
-    IntPoint touch_point();
-    bool touch_down();
-    bool shift();
-    bool ctrl();
+    /* Plays an evdev recording back in real time, other producers are
+       ignored until it finished */
+    void start_replay(const std::string& path);
+
+    /* Moves the queued events over, coalescing moves if enabled */
+    void poll_events();
+    /* Takes the next event and applies it to the state, false when none is left */
+    bool next_event(InputEvent& event);
+
+    IntPoint touch_point() const { return m_state.touch_point; }
+    bool touch_down() const { return m_state.touch_down; }
+    bool shift() const { return m_state.shift_down; }
+    bool ctrl() const { return m_state.ctrl_down; }
     int scroll_y();
-    int peek_scroll_y();
+    int peek_scroll_y() const { return m_state.scroll_y; }
 
-    KeyCode key();
+    /* Producer side, timestamp_ns 0 stamps the event now */
+    void push_touch(IntPoint point, bool down, uint64_t timestamp_ns = 0);
+    void push_key(KeyCode key, uint64_t timestamp_ns = 0);
+    void push_shift(bool down, uint64_t timestamp_ns = 0);
+    void push_ctrl(bool down, uint64_t timestamp_ns = 0);
+    void push_scroll(int y, uint64_t timestamp_ns = 0);
 
-    void set_touch(IntPoint point, bool down);
-    void set_key(KeyCode key);
-    void set_shift(bool down);
-    void set_ctrl(bool down);
-    void set_scroll(int y);
+    static uint64_t now_ns();
 
 private:
     Input(); 
     ~Input();
 
-    void run_thread();
+    /* Producer lock held */
+    bool accepts_producer() const;
+    void push(InputEvent event, uint64_t timestamp_ns);
+
+    InputQueue m_queue;
+
+    // The queue takes a single producer at a time; SDL on the UI thread,
+    // the evdev reader and a replay can all push. Guards the state below.
+    std::mutex m_producer_mutex;
+    // To tell downs, moves and ups apart
+    IntPoint m_producer_point = {0, 0};
+    bool m_producer_down = false;
+    bool m_producer_shift = false;
+    bool m_producer_ctrl = false;
 
+    // UI thread only
     InputState m_state;
-    std::mutex m_mutex;
+    std::vector<InputEvent> m_drained;
+    std::deque<InputEvent> m_pending;
 
-    std::atomic<bool> m_running{false};
-    std::thread m_worker_thread;
+    EvdevReader m_reader;
+    std::atomic<bool> m_replaying{false};
+    std::thread m_replay_thread;
 };
 
 } 
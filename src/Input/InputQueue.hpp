@@ -0,0 +1,93 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "Geometry/Primitives.hpp"
+#include "KeyCode.hpp"
+
+namespace Izo {
+
+enum class InputEventType : uint8_t {
+    TouchDown,
+    TouchMove,  // also pointer hover, down is false then
+    TouchUp,
+    Key,
+    Scroll,
+    Modifiers,
+};
+
+struct InputEvent {
+    InputEventType type = InputEventType::TouchMove;
+    uint64_t timestamp_ns = 0;  // CLOCK_MONOTONIC
+    IntPoint point = {0, 0};
+    bool down = false;
+    bool shift = false;
+    bool ctrl = false;
+    KeyCode key = KeyCode::None;
+    int scroll = 0;
+};
+
+/* Single producer, single consumer queue of input events. The producer is
+   the platform reader (the Android input thread or DesktopApp, which pumps
+   on the UI thread), the consumer is the UI thread. Pushing never blocks
+   and never drops: once the ring is full, events go to a locked overflow
+   list until the consumer caught up, which keeps them in order. */
+class InputQueue {
+public:
+    static constexpr size_t kCapacity = 1024;
+
+    void push(const InputEvent& event) {
+        if (!m_overflowing.load(std::memory_order_acquire)) {
+            size_t head = m_head.load(std::memory_order_relaxed);
+            if (head - m_tail.load(std::memory_order_acquire) < kCapacity) {
+                m_slots[head % kCapacity] = event;
+                m_head.store(head + 1, std::memory_order_release);
+                return;
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(m_overflow_mutex);
+        m_overflow.push_back(event);
+        m_overflowing.store(true, std::memory_order_release);
+    }
+
+    /* Appends every queued event to out, oldest first */
+    void drain(std::vector<InputEvent>& out) {
+        // The flag is read first: if it was set, every ring event older than
+        // the overflow is below the head loaded after it. An overflow that
+        // starts later waits for the next drain, the producer keeps using it
+        // until then.
+        bool overflowing = m_overflowing.load(std::memory_order_acquire);
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        size_t head = m_head.load(std::memory_order_acquire);
+        for (; tail != head; ++tail) {
+            out.push_back(m_slots[tail % kCapacity]);
+        }
+        m_tail.store(tail, std::memory_order_release);
+
+        // Events only go to the overflow while the producer sees the flag,
+        // so everything in there is newer than what was in the ring
+        if (overflowing) {
+            std::lock_guard<std::mutex> lock(m_overflow_mutex);
+            out.insert(out.end(), m_overflow.begin(), m_overflow.end());
+            m_overflow.clear();
+            m_overflowing.store(false, std::memory_order_release);
+        }
+    }
+
+private:
+    std::array<InputEvent, kCapacity> m_slots;
+    alignas(64) std::atomic<size_t> m_head{0};
+    alignas(64) std::atomic<size_t> m_tail{0};
+
+    std::atomic<bool> m_overflowing{false};
+    std::mutex m_overflow_mutex;
+    std::vector<InputEvent> m_overflow;
+};
+
+}
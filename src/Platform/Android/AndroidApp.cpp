@@ -2,8 +2,13 @@
 
 #include "Platform/Android/AndroidApp.hpp"
 
+#include <cstdint>
 #include <cstdlib>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
 
+#include "Core/Settings.hpp"
 #include "Graphics/Canvas.hpp"
 #include "Platform/Android/AndroidDevice.hpp"
 
@@ -12,18 +17,31 @@ namespace Izo {
 AndroidApp::AndroidApp(int width, int height, std::string)
     : m_width(static_cast<uint32_t>(width)),
       m_height(static_cast<uint32_t>(height)) {
+    m_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    m_wake_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = m_wake_fd;
+    epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, m_wake_fd, &event);
 }
 
 AndroidApp::~AndroidApp() {
     AndroidDevice::set_brightness(0);
+    close(m_wake_fd);
+    close(m_epoll_fd);
 }
 
 bool AndroidApp::init() {
     std::system("stop");
-    if (!m_fb.init()) {
+    if (!m_fb.init("/dev/graphics/fb0", Settings::triple_buffering.get() ? 3 : 2)) {
         return false;
     }
 
+    // Fixed for the run, a canvas of our own misses every frame drawn
+    // into the framebuffer, so switching back would present stale pixels
+    m_zero_copy = Settings::zero_copy_present.get();
+
     m_width = static_cast<uint32_t>(m_fb.width());
     m_height = static_cast<uint32_t>(m_fb.height());
     if (m_on_resize) {
@@ -36,12 +54,29 @@ bool AndroidApp::pump_events() {
     return true;
 }
 
+void AndroidApp::wait_events(int timeout_ms) {
+    epoll_event event;
+    if (epoll_wait(m_epoll_fd, &event, 1, timeout_ms) > 0) {
+        uint64_t count;
+        [[maybe_unused]] auto result = read(m_wake_fd, &count, sizeof(count));
+    }
+}
+
+void AndroidApp::wake() {
+    uint64_t one = 1;
+    [[maybe_unused]] auto result = write(m_wake_fd, &one, sizeof(one));
+}
+
 void AndroidApp::present(Canvas& canvas, std::span<const IntRect> dirty_rects) {
     if (m_fb.valid()) {
         m_fb.swap_buffers(canvas, dirty_rects);
     }
 }
 
+bool AndroidApp::attach_back_buffer(Canvas& canvas) {
+    return m_zero_copy && m_fb.valid() && m_fb.attach_back_buffer(canvas);
+}
+
 void AndroidApp::quit(int exit_code) {
     AndroidDevice::set_brightness(0);
     std::system("start");
@@ -17,7 +17,12 @@ public:
 
     bool init() override;
     bool pump_events() override;
+    void wait_events(int timeout_ms) override;
+    void wake() override;
     void present(Canvas& canvas, std::span<const IntRect> dirty_rects) override;
+    bool attach_back_buffer(Canvas& canvas) override;
+    std::chrono::steady_clock::time_point last_vsync() const override { return m_fb.last_vsync(); }
+    std::chrono::nanoseconds refresh_period() const override { return m_fb.refresh_period(); }
     void quit(int exit_code) override;
     void show() override;
 
@@ -28,6 +33,10 @@ public:
 
 private:
     Framebuffer m_fb;
+    bool m_zero_copy{false};
+    // The input thread and TaskPool posts end a wait through the eventfd
+    int m_epoll_fd{-1};
+    int m_wake_fd{-1};
     uint32_t m_width;
     uint32_t m_height;
     std::function<void(int, int)> m_on_resize;
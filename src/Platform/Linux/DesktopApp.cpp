@@ -1,8 +1,10 @@
 #include "Platform/Linux/DesktopApp.hpp"
 
 #include <SDL_render.h>
+#include <algorithm>
 #include <cstdlib>
 
+#include "Core/Application.hpp"
 #include "Debug/Logger.hpp"
 #include "Graphics/Canvas.hpp"
 #include "Input/Input.hpp"
@@ -52,8 +54,14 @@ bool DesktopApp::init() {
         return false;
     }
 
+    m_ui_thread = std::this_thread::get_id();
     SDL_StartTextInput();
 
+    Uint32 wake_event = SDL_RegisterEvents(1);
+    if (wake_event != static_cast<Uint32>(-1)) {
+        m_wake_event.store(wake_event, std::memory_order_release);
+    }
+
     m_window = SDL_CreateWindow(
         m_caption.c_str(),
         SDL_WINDOWPOS_CENTERED,
@@ -90,7 +98,43 @@ bool DesktopApp::init() {
     return true;
 }
 
+void DesktopApp::wait_events(int timeout_ms) {
+    // Leaves the event queued, pump_events() handles it
+    if (timeout_ms < 0) {
+        SDL_WaitEvent(nullptr);
+    } else {
+        SDL_WaitEventTimeout(nullptr, timeout_ms);
+    }
+    // Wake events carry nothing, left queued they would end every later
+    // wait right away
+    if (Uint32 type = m_wake_event.load(std::memory_order_acquire)) {
+        SDL_FlushEvent(type);
+    }
+    // The wake-up may be the render thread with a new frame, which should
+    // not wait for the next pump_events()
+    present_staged();
+}
+
+void DesktopApp::wake() {
+    Uint32 type = m_wake_event.load(std::memory_order_acquire);
+    if (type == 0) return;
+
+    SDL_Event event{};
+    event.type = type;
+    SDL_PushEvent(&event);
+}
+
+std::chrono::nanoseconds DesktopApp::refresh_period() const {
+    SDL_DisplayMode mode{};
+    if (!m_window || SDL_GetWindowDisplayMode(m_window, &mode) != 0 || mode.refresh_rate <= 0) {
+        return std::chrono::nanoseconds::zero();
+    }
+    return std::chrono::nanoseconds(1000000000ll / mode.refresh_rate);
+}
+
 bool DesktopApp::pump_events() {
+    present_staged();
+
     SDL_Event e;
     while (SDL_PollEvent(&e)) {
         if (e.type == SDL_QUIT) {
@@ -108,60 +152,60 @@ bool DesktopApp::pump_events() {
                 if (m_on_resize) m_on_resize(w, h);
             }
         } else if (e.type == SDL_MOUSEWHEEL) {
-            Input::the().set_scroll(e.wheel.y);
+            Input::the().push_scroll(e.wheel.y);
         } else if (e.type == SDL_MOUSEMOTION) {
-            Input::the().set_touch({e.motion.x, e.motion.y}, (e.motion.state & SDL_BUTTON_LMASK) != 0);
+            Input::the().push_touch({e.motion.x, e.motion.y}, (e.motion.state & SDL_BUTTON_LMASK) != 0);
         } else if (e.type == SDL_MOUSEBUTTONDOWN) {
-            Input::the().set_touch({e.button.x, e.button.y}, true);
+            Input::the().push_touch({e.button.x, e.button.y}, true);
         } else if (e.type == SDL_MOUSEBUTTONUP) {
-            Input::the().set_touch({e.button.x, e.button.y}, false);
+            Input::the().push_touch({e.button.x, e.button.y}, false);
         } else if (e.type == SDL_TEXTINPUT) {
             if (e.text.text[0]) {
-                Input::the().set_key((KeyCode)e.text.text[0]);
+                Input::the().push_key((KeyCode)e.text.text[0]);
             }
         } else if (e.type == SDL_KEYDOWN || e.type == SDL_KEYUP) {
             bool down = (e.type == SDL_KEYDOWN);
             if (e.key.keysym.sym == SDLK_LSHIFT || e.key.keysym.sym == SDLK_RSHIFT) {
-                Input::the().set_shift(down);
+                Input::the().push_shift(down);
             } else if (e.key.keysym.sym == SDLK_LCTRL || e.key.keysym.sym == SDLK_RCTRL) {
-                Input::the().set_ctrl(down);
+                Input::the().push_ctrl(down);
             }
 
             if (down) {
                 if (e.key.keysym.sym == SDLK_BACKSPACE) {
-                    Input::the().set_key(KeyCode::Backspace);
+                    Input::the().push_key(KeyCode::Backspace);
                 } else if (e.key.keysym.sym == SDLK_DELETE) {
-                    Input::the().set_key(KeyCode::Delete);
+                    Input::the().push_key(KeyCode::Delete);
                 } else if (e.key.keysym.sym == SDLK_RETURN) {
-                    Input::the().set_key(KeyCode::Enter);
+                    Input::the().push_key(KeyCode::Enter);
                 } else if (e.key.keysym.sym == SDLK_LEFT) {
-                    Input::the().set_key(KeyCode::Left);
+                    Input::the().push_key(KeyCode::Left);
                 } else if (e.key.keysym.sym == SDLK_RIGHT) {
-                    Input::the().set_key(KeyCode::Right);
+                    Input::the().push_key(KeyCode::Right);
                 } else if (e.key.keysym.sym == SDLK_UP) {
-                    Input::the().set_key(KeyCode::Up);
+                    Input::the().push_key(KeyCode::Up);
                 } else if (e.key.keysym.sym == SDLK_DOWN) {
-                    Input::the().set_key(KeyCode::Down);
+                    Input::the().push_key(KeyCode::Down);
                 } else if (e.key.keysym.sym == SDLK_HOME) {
-                    Input::the().set_key(KeyCode::Home);
+                    Input::the().push_key(KeyCode::Home);
                 } else if (e.key.keysym.sym == SDLK_END) {
-                    Input::the().set_key(KeyCode::End);
+                    Input::the().push_key(KeyCode::End);
                 } else if (e.key.keysym.sym == SDLK_PAGEUP) {
-                    Input::the().set_key(KeyCode::PageUp);
+                    Input::the().push_key(KeyCode::PageUp);
                 } else if (e.key.keysym.sym == SDLK_PAGEDOWN) {
-                    Input::the().set_key(KeyCode::PageDown);
+                    Input::the().push_key(KeyCode::PageDown);
                 } else if (e.key.keysym.sym == SDLK_ESCAPE) {
-                    Input::the().set_key(KeyCode::Escape);
+                    Input::the().push_key(KeyCode::Escape);
                 } else if (e.key.keysym.sym == SDLK_a && (e.key.keysym.mod & KMOD_CTRL)) {
-                    Input::the().set_key((KeyCode)'a');
+                    Input::the().push_key((KeyCode)'a');
                 } else if (e.key.keysym.sym == SDLK_c && (e.key.keysym.mod & KMOD_CTRL)) {
-                    Input::the().set_key((KeyCode)'c');
+                    Input::the().push_key((KeyCode)'c');
                 } else if (e.key.keysym.sym == SDLK_v && (e.key.keysym.mod & KMOD_CTRL)) {
-                    Input::the().set_key((KeyCode)'v');
+                    Input::the().push_key((KeyCode)'v');
                 } else if (e.key.keysym.sym == SDLK_x && (e.key.keysym.mod & KMOD_CTRL)) {
-                    Input::the().set_key((KeyCode)'x');
+                    Input::the().push_key((KeyCode)'x');
                 } else if (e.key.keysym.sym == SDLK_d && (e.key.keysym.mod & KMOD_CTRL)) {
-                    Input::the().set_key((KeyCode)'d');
+                    Input::the().push_key((KeyCode)'d');
                 }
             }
         }
@@ -170,22 +214,77 @@ bool DesktopApp::pump_events() {
 }
 
 void DesktopApp::present(Canvas& canvas, std::span<const IntRect> dirty_rects) {
-    if (!m_texture || !m_renderer) return;
+    if (std::this_thread::get_id() != m_ui_thread) {
+        {
+            std::lock_guard<std::mutex> lock(m_staging_mutex);
+            size_t size = static_cast<size_t>(canvas.width()) * static_cast<size_t>(canvas.height());
+            if (m_staged_width != canvas.width() || m_staged_height != canvas.height()) {
+                m_staged_pixels.assign(size, 0);
+                m_staged_width = canvas.width();
+                m_staged_height = canvas.height();
+                m_staged_rects.clear();
+                m_staged_full = true;
+            }
+
+            // Frames the UI thread has not uploaded yet accumulate
+            auto stage = [&](const IntRect& rect) {
+                for (int y = rect.y; y < rect.bottom(); ++y) {
+                    size_t offset = static_cast<size_t>(y) * static_cast<size_t>(canvas.width()) + static_cast<size_t>(rect.x);
+                    std::copy_n(canvas.row(y) + rect.x, rect.w, m_staged_pixels.begin() + static_cast<ptrdiff_t>(offset));
+                }
+            };
+            if (dirty_rects.empty()) {
+                stage({0, 0, canvas.width(), canvas.height()});
+                m_staged_full = true;
+            } else {
+                for (const auto& rect : dirty_rects) {
+                    IntRect clipped = rect.intersection({0, 0, canvas.width(), canvas.height()});
+                    if (clipped.w <= 0 || clipped.h <= 0) continue;
+
+                    stage(clipped);
+                    m_staged_rects.push_back(clipped);
+                }
+            }
+            m_staged = true;
+        }
+        Application::wake();
+        return;
+    }
+
     if (canvas.width() != static_cast<int>(m_width) || canvas.height() != static_cast<int>(m_height)) return;
+    upload(canvas.pixels(), canvas.stride(), dirty_rects);
+}
+
+void DesktopApp::present_staged() {
+    std::lock_guard<std::mutex> lock(m_staging_mutex);
+    if (!m_staged) return;
+    m_staged = false;
+
+    // Rendered before a resize, the next frame covers the new size
+    if (m_staged_width == static_cast<int>(m_width) && m_staged_height == static_cast<int>(m_height)) {
+        upload(m_staged_pixels.data(), m_staged_width,
+               m_staged_full ? std::span<const IntRect>{} : std::span<const IntRect>(m_staged_rects));
+    }
+    m_staged_rects.clear();
+    m_staged_full = false;
+}
+
+void DesktopApp::upload(const uint32_t* pixels, int pitch_pixels, std::span<const IntRect> dirty_rects) {
+    if (!m_texture || !m_renderer) return;
 
     bool full_upload = m_texture_needs_full_upload || dirty_rects.empty();
+    const int pitch = pitch_pixels * static_cast<int>(sizeof(uint32_t));
 
     if (full_upload) {
-        SDL_UpdateTexture(m_texture, nullptr, canvas.pixels(), canvas.width() * static_cast<int>(sizeof(uint32_t)));
+        SDL_UpdateTexture(m_texture, nullptr, pixels, pitch);
         m_texture_needs_full_upload = false;
     } else {
-        const int pitch = canvas.width() * static_cast<int>(sizeof(uint32_t));
         for (const auto& rect : dirty_rects) {
-            IntRect clipped = rect.intersection({0, 0, canvas.width(), canvas.height()});
+            IntRect clipped = rect.intersection({0, 0, static_cast<int>(m_width), static_cast<int>(m_height)});
             if (clipped.w <= 0 || clipped.h <= 0) continue;
 
             SDL_Rect sdl_rect{clipped.x, clipped.y, clipped.w, clipped.h};
-            const auto* src = reinterpret_cast<const uint8_t*>(canvas.pixels() + clipped.y * canvas.width() + clipped.x);
+            const auto* src = reinterpret_cast<const uint8_t*>(pixels + clipped.y * pitch_pixels + clipped.x);
             SDL_UpdateTexture(m_texture, &sdl_rect, src, pitch);
         }
     }
@@ -1,9 +1,13 @@
 #pragma once
 
 #include <SDL.h>
+#include <atomic>
 #include <cstdint>
 #include <functional>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "Core/AppImplementation.hpp"
 
@@ -16,7 +20,14 @@ public:
 
     bool init() override;
     bool pump_events() override;
+    void wait_events(int timeout_ms) override;
+    void wake() override;
     void present(Canvas& canvas, std::span<const IntRect> dirty_rects) override;
+    // Texture memory is only reachable while locked on the UI thread
+    bool attach_back_buffer(Canvas&) override { return false; }
+    // SDL does not expose vsync timing
+    std::chrono::steady_clock::time_point last_vsync() const override { return {}; }
+    std::chrono::nanoseconds refresh_period() const override;
     void quit(int exit_code) override;
     void show() override;
 
@@ -27,16 +38,32 @@ public:
 
 private:
     bool recreate_texture(uint32_t w, uint32_t h);
+    void upload(const uint32_t* pixels, int pitch_pixels, std::span<const IntRect> dirty_rects);
+    /* Puts a frame presented off the UI thread on screen */
+    void present_staged();
 
     std::string m_caption;
     SDL_Window* m_window{nullptr};
     SDL_Renderer* m_renderer{nullptr};
     SDL_Texture* m_texture{nullptr};
     bool m_running{false};
+    // SDL user event that wake() pushes, 0 until init() registered it
+    std::atomic<Uint32> m_wake_event{0};
     bool m_texture_needs_full_upload{true};
     uint32_t m_width{0};
     uint32_t m_height{0};
 
+    // SDL may only be used from the thread that created the window. Frames
+    // presented from elsewhere are copied here and uploaded by pump_events().
+    std::thread::id m_ui_thread;
+    std::mutex m_staging_mutex;
+    std::vector<uint32_t> m_staged_pixels;
+    std::vector<IntRect> m_staged_rects;
+    int m_staged_width{0};
+    int m_staged_height{0};
+    bool m_staged{false};
+    bool m_staged_full{false};
+
     std::function<void(int, int)> m_on_resize;
 };
 
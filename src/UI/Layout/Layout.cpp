@@ -3,6 +3,7 @@
 #include "Graphics/Painter.hpp"
 #include "Graphics/Color.hpp"
 #include "Core/Application.hpp"
+#include "Core/ViewManager.hpp"
 
 #include <cmath>
 
@@ -23,7 +24,7 @@ constexpr float kMinOverscrollBarFactor = 0.3f;
 constexpr float kAutoScrollSnapEpsilon = 0.75f;
 constexpr float kAutoScrollVelocityEps = 0.75f;
 
-void Layout::measure(int parent_w, int parent_h) { 
+void Layout::measure_content(int parent_w, int parent_h) { 
     m_measured_size = {0, 0, 0, 0};
     if (m_width == (int)WidgetSizePolicy::MatchParent) m_measured_size.w = parent_w;
     if (m_height == (int)WidgetSizePolicy::MatchParent) m_measured_size.h = parent_h;
@@ -45,10 +46,7 @@ void Layout::smooth_scroll_to(int target_y) {
 
 void Layout::update() {
     const float prev_scroll_y = m_scroll_y;
-    const float prev_velocity_y = m_velocity_y;
     const float prev_scrollbar_alpha = m_scrollbar_alpha;
-    const bool prev_auto_scrolling = m_auto_scrolling;
-    const bool prev_is_dragging = m_is_dragging;
 
     int total_content_height = content_height();
     int max_scroll = (total_content_height > global_bounds().h) ? -(total_content_height - global_bounds().h) : 0;
@@ -102,15 +100,51 @@ void Layout::update() {
         m_scrollbar_alpha = 255;
     }
 
+    int scroll_delta = (int)m_scroll_y - (int)prev_scroll_y;
+    if (scroll_delta != 0) {
+        scroll_contents(scroll_delta);
+    } else if (std::abs(m_scroll_y - prev_scroll_y) > 0.01f ||
+               std::abs(m_scrollbar_alpha - prev_scrollbar_alpha) > 0.01f) {
+        invalidate_scrollbar();
+    }
+
     Container::update();
+}
+
+int Layout::scroll_blit_inset() const {
+    if (m_focus_anim.value() <= 0.0f) return 0;
+    return std::max(m_focus_outline_thickness, m_focus_roundness) + 1;
+}
 
-    if (std::abs(m_scroll_y - prev_scroll_y) > 0.01f ||
-        std::abs(m_velocity_y - prev_velocity_y) > 0.01f ||
-        std::abs(m_scrollbar_alpha - prev_scrollbar_alpha) > 0.01f ||
-        m_auto_scrolling != prev_auto_scrolling ||
-        m_is_dragging != prev_is_dragging) {
+/* Moves the already rendered content instead of repainting it, so only the
+   strip scrolled into view, the edges and the scrollbar get drawn again */
+void Layout::scroll_contents(int dy) {
+    if (!m_visible) return;
+
+    IntRect bounds = global_bounds();
+    IntRect visible = bounds;
+    for (const Widget* ancestor = m_parent; ancestor; ancestor = ancestor->parent()) {
+        visible = visible.intersection(ancestor->global_bounds());
+    }
+
+    int inset = scroll_blit_inset();
+    IntRect area = visible.intersection({bounds.x, bounds.y + inset, bounds.w, bounds.h - inset * 2});
+    if (area.w <= 0 || area.h <= 0 || !ViewManager::the().scroll_rect(this, area, dy)) {
         invalidate_visual();
+        return;
     }
+
+    if (inset > 0) {
+        ViewManager::the().invalidate_rect({bounds.x, bounds.y, bounds.w, inset});
+        ViewManager::the().invalidate_rect({bounds.x, bounds.bottom() - inset, bounds.w, inset});
+    }
+    invalidate_scrollbar();
+}
+
+void Layout::invalidate_scrollbar() {
+    if (!m_visible) return;
+    IntRect b = global_bounds();
+    ViewManager::the().invalidate_rect({b.x + b.w - kScrollbarInsetPx, b.y, kScrollbarInsetPx, b.h});
 }
 
 bool Layout::on_scroll(int y) {
@@ -126,7 +160,7 @@ bool Layout::on_scroll(int y) {
         if (y != 0) {
             m_velocity_y += (float)y * kMouseScrollVelocityScale;
             m_scrollbar_alpha = 255;
-            invalidate_visual();
+            invalidate_scrollbar();
             return true;
         }
     }
@@ -142,7 +176,8 @@ void Layout::draw_content(Painter& painter) {
     int visible_top = b.y - margin;
     int visible_bottom = b.y + b.h + margin;
 
-    for (auto& child : m_children) {
+    for (size_t i = first_unoccluded_child(painter); i < m_children.size(); ++i) {
+        auto& child = m_children[i];
         if (!child->visible()) continue;
 
         IntRect cb = child->global_bounds();
@@ -286,15 +321,20 @@ bool Layout::on_touch_event(IntPoint point, bool down) {
             float dt_sec = Application::the().delta() * 0.001f;
             dt_sec = std::clamp(dt_sec, 0.001f, 0.1f);
             m_velocity_y = diff / dt_sec;
+
+            int prev_offset = (int)m_scroll_y;
             m_scroll_y += diff;
+            if ((int)m_scroll_y != prev_offset) {
+                scroll_contents((int)m_scroll_y - prev_offset);
+            }
         }
         m_last_touch_y = ty;
-        invalidate_visual();
+        invalidate_scrollbar();
         return true; 
     } else {
         if (m_is_dragging) {
             m_is_dragging = false;
-            invalidate_visual();
+            invalidate_scrollbar();
         }
         return false;
     }
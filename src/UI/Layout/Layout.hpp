@@ -9,7 +9,7 @@ public:
     void layout() override { layout_children(); }
     virtual void layout_children() = 0;
 
-    void measure(int parent_w, int parent_h) override;
+    void measure_content(int parent_w, int parent_h) override;
     void update() override;
     void draw_content(Painter& painter) override;
     void draw_focus(Painter& painter) override;
@@ -25,6 +25,11 @@ public:
 
 protected:
     virtual int content_height() const = 0;
+    /* Rows at the top and bottom edge that do not move with the content */
+    virtual int scroll_blit_inset() const;
+
+    void scroll_contents(int dy);
+    void invalidate_scrollbar();
 
     float m_scroll_y = 0.0f;
     float m_velocity_y = 0.0f;
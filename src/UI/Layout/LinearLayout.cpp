@@ -7,10 +7,7 @@ LinearLayout::LinearLayout(Orientation orientation)
     on_theme_update();
 }
 
-void LinearLayout::measure(int parent_w, int parent_h) {
-    int w = 0;
-    int h = 0;
-
+void LinearLayout::measure_content(int parent_w, int parent_h) {
     int available_w = (m_width == (int)WidgetSizePolicy::MatchParent) ? parent_w : 0;
     int available_h = (m_height == (int)WidgetSizePolicy::MatchParent) ? parent_h : 0;
 
@@ -21,10 +18,25 @@ void LinearLayout::measure(int parent_w, int parent_h) {
     int content_w = available_w - m_padding.left - m_padding.right;
     int content_h = available_h - m_padding.top - m_padding.bottom;
 
-    bool first = true;
     for (auto& child : m_children) {
         if (!child->visible()) continue;
         child->measure(content_w, content_h); 
+    }
+
+    stack_children(parent_w, parent_h);
+}
+
+void LinearLayout::on_measure_restored(int parent_w, int parent_h) {
+    stack_children(parent_w, parent_h);
+}
+
+void LinearLayout::stack_children(int parent_w, int parent_h) {
+    int w = 0;
+    int h = 0;
+
+    bool first = true;
+    for (auto& child : m_children) {
+        if (!child->visible()) continue;
 
         if (m_orientation == Orientation::Vertical) {
             if (!first) h += 10; // Spacing
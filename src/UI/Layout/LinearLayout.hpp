@@ -10,12 +10,16 @@ public:
     LinearLayout(Orientation orientation = Orientation::Vertical);
 
     void layout_children() override;
-    void measure(int parent_w, int parent_h) override;
+    void measure_content(int parent_w, int parent_h) override;
 
 protected:
     int content_height() const override { return m_content_height; }
+    void on_measure_restored(int parent_w, int parent_h) override;
 
 private:
+    /* Sizes the layout from the measured sizes of its children */
+    void stack_children(int parent_w, int parent_h);
+
     Orientation m_orientation;
 };
 
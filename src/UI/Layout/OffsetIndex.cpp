@@ -0,0 +1,104 @@
+#include "UI/Layout/OffsetIndex.hpp"
+
+namespace Izo {
+
+static inline size_t lowest_bit(size_t i) {
+    return i & (~i + 1);
+}
+
+void OffsetIndex::clear() {
+    m_extents.clear();
+    m_tree.assign(1, 0);
+    m_total = 0;
+}
+
+void OffsetIndex::assign(const std::vector<int>& extents) {
+    m_extents = extents;
+    rebuild();
+}
+
+void OffsetIndex::resize(size_t count, int estimate) {
+    if (count < m_extents.size()) {
+        m_extents.resize(count);
+        rebuild();
+        return;
+    }
+    while (m_extents.size() < count) {
+        push_back(estimate);
+    }
+}
+
+void OffsetIndex::push_back(int extent) {
+    if (m_tree.empty()) m_tree.assign(1, 0);
+
+    // The new node covers (i - lowbit(i), i], so it needs the sum of the
+    // already present items in that range plus its own extent.
+    size_t i = m_extents.size() + 1;
+    int node = extent;
+    size_t covered_from = i - lowest_bit(i);
+    for (size_t j = i - 1; j > covered_from; j -= lowest_bit(j)) {
+        node += m_tree[j];
+    }
+
+    m_extents.push_back(extent);
+    m_tree.push_back(node);
+    m_total += extent;
+}
+
+void OffsetIndex::set(size_t index, int extent) {
+    if (index >= m_extents.size()) return;
+
+    int delta = extent - m_extents[index];
+    if (delta == 0) return;
+
+    m_extents[index] = extent;
+    m_total += delta;
+    for (size_t i = index + 1; i < m_tree.size(); i += lowest_bit(i)) {
+        m_tree[i] += delta;
+    }
+}
+
+int OffsetIndex::offset_of(size_t index) const {
+    if (index >= m_extents.size()) return m_total;
+
+    int sum = 0;
+    for (size_t i = index; i > 0; i -= lowest_bit(i)) {
+        sum += m_tree[i];
+    }
+    return sum;
+}
+
+size_t OffsetIndex::index_at(int offset) const {
+    const size_t count = m_extents.size();
+    if (count == 0 || offset <= 0) return 0;
+
+    size_t step = 1;
+    while (step * 2 <= count) step *= 2;
+
+    size_t pos = 0;
+    int remaining = offset;
+    for (; step > 0; step /= 2) {
+        size_t next = pos + step;
+        if (next <= count && m_tree[next] <= remaining) {
+            pos = next;
+            remaining -= m_tree[next];
+        }
+    }
+
+    return pos < count ? pos : count - 1;
+}
+
+void OffsetIndex::rebuild() {
+    const size_t count = m_extents.size();
+    m_tree.assign(count + 1, 0);
+    m_total = 0;
+
+    for (size_t i = 1; i <= count; ++i) {
+        m_tree[i] += m_extents[i - 1];
+        m_total += m_extents[i - 1];
+        size_t parent = i + lowest_bit(i);
+        if (parent <= count) m_tree[parent] += m_tree[i];
+    }
+}
+
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace Izo {
+
+/* Prefix-sum index over item extents (Fenwick tree). Converts between
+   item index and content offset in O(log n), used by scrolling lists. */
+class OffsetIndex {
+public:
+    void clear();
+    void assign(const std::vector<int>& extents);
+    void resize(size_t count, int estimate);
+    void push_back(int extent);
+    void set(size_t index, int extent);
+
+    size_t size() const { return m_extents.size(); }
+    bool empty() const { return m_extents.empty(); }
+    int extent(size_t index) const { return m_extents[index]; }
+    int total() const { return m_total; }
+
+    /* Sum of the extents of all items before index */
+    int offset_of(size_t index) const;
+    /* Index of the item covering offset, clamped to the valid range */
+    size_t index_at(int offset) const;
+
+private:
+    void rebuild();
+
+    std::vector<int> m_extents;
+    std::vector<int> m_tree;  // 1-based
+    int m_total = 0;
+};
+
+}
@@ -26,6 +26,11 @@ void View::update() {
     auto run_layout_pass = [&]() {
         if (!m_root || !m_root->subtree_layout_dirty()) return;
 
+        if (!m_root->layout_dirty()) {
+            m_root->layout_dirty_subtrees();
+            return;
+        }
+
         m_root->set_bounds({0, 0, m_width, m_height});
         m_root->measure(m_width, m_height);
 
@@ -105,6 +110,10 @@ void View::on_key(KeyCode key) {
     if (m_root) m_root->on_key(key);
 }
 
+bool View::is_opaque_in(const IntRect& rect) const {
+    return m_root && m_root->is_opaque_in(rect);
+}
+
 bool View::has_running_animations() const {
     return m_root ? m_root->has_running_animations() : false;
 }
@@ -19,6 +19,8 @@ public:
     void update();
     void draw(Painter& painter);
     bool has_running_animations() const;
+    bool is_opaque_in(const IntRect& rect) const;
+    Widget* root() const { return m_root.get(); }
 
     void on_touch(IntPoint point, bool down);
     void on_scroll(int y);
@@ -165,7 +165,7 @@ bool Button::on_key(KeyCode key) {
     return false;
 }
 
-void Button::measure(int parent_w, int parent_h) {
+void Button::measure_content(int parent_w, int parent_h) {
     int mw = 50, mh = 20;
     if (m_label) {
         m_label->measure(parent_w, parent_h);
@@ -175,6 +175,12 @@ void Button::measure(int parent_w, int parent_h) {
     m_measured_size = {0, 0, mw, mh};
 }
 
+bool Button::is_opaque_in(const IntRect& rect) const {
+    // draw_content() reshapes buttons crossing the screen edge, keep it simple for those
+    if (!Application::the().screen_rect().contains(global_bounds())) return false;
+    return rounded_background_covers(rect, m_roundness, m_bg_anim.value());
+}
+
 bool Button::has_running_animations() const {
     return Widget::has_running_animations() || m_bg_anim.running() ||
            (m_label && m_label->has_running_animations());
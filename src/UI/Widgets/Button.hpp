@@ -23,11 +23,15 @@ public:
     void update() override;
     bool on_touch_event(IntPoint point, bool down) override;
     bool on_key(KeyCode key) override;
-    void measure(int parent_w, int parent_h) override;
+    void measure_content(int parent_w, int parent_h) override;
+    bool is_relayout_boundary() const override { return false; }
+    bool is_opaque_in(const IntRect& rect) const override;
     bool has_running_animations() const override;
 
     void set_on_click(std::function<void()> callback) { m_on_click = callback; }
 
+protected:
+
 private:
     std::unique_ptr<Label> m_label;
     bool m_pressed = false;
@@ -17,13 +17,37 @@ void Container::add_child(std::unique_ptr<Widget> child) {
 
 void Container::draw_content(Painter& painter) {
     painter.push_clip(global_bounds());
-    for (auto& child : m_children) {
+    for (size_t i = first_unoccluded_child(painter); i < m_children.size(); ++i) {
+        auto& child = m_children[i];
         if (child->visible())
             child->draw(painter);
     }
     painter.pop_clip();
 }
 
+size_t Container::first_unoccluded_child(const Painter& painter) const {
+    if (painter.global_alpha() < 1.0f) return 0;
+
+    IntRect clip = painter.clip_rect();
+    clip.x -= painter.translation().x;
+    clip.y -= painter.translation().y;
+
+    for (size_t i = m_children.size(); i-- > 0;) {
+        const auto& child = m_children[i];
+        if (child->visible() && child->is_opaque_in(clip)) return i;
+    }
+    return 0;
+}
+
+bool Container::is_opaque_in(const IntRect& rect) const {
+    if (!m_visible || !global_bounds().contains(rect)) return false;
+
+    for (auto it = m_children.rbegin(); it != m_children.rend(); ++it) {
+        if ((*it)->visible() && (*it)->is_opaque_in(rect)) return true;
+    }
+    return false;
+}
+
 bool Container::on_touch(IntPoint point, bool down, bool captured) {
     if (m_captured_child) {
         m_captured_child->on_touch(point, down, true);
@@ -109,20 +133,31 @@ void Container::collect_focusable_widgets(std::vector<Widget*>& out_list) {
 void Container::layout() {
 }
 
-bool Container::subtree_layout_dirty() const {
-    if (layout_dirty()) return true;
-    for (const auto& child : m_children) {
+void Container::clear_layout_dirty_subtree() {
+    Widget::clear_layout_dirty_subtree();
+    for (auto& child : m_children) {
         if (child->subtree_layout_dirty()) {
-            return true;
+            child->clear_layout_dirty_subtree();
         }
     }
-    return false;
 }
 
-void Container::clear_layout_dirty_subtree() {
-    m_layout_dirty = false;
+void Container::layout_dirty_subtrees() {
+    if (layout_dirty()) {
+        Widget::layout_dirty_subtrees();
+        return;
+    }
+
+    m_descendant_layout_dirty = false;
     for (auto& child : m_children) {
-        child->clear_layout_dirty_subtree();
+        if (!child->subtree_layout_dirty()) continue;
+
+        // Hidden children are laid out again by their parent once shown
+        if (child->visible()) {
+            child->layout_dirty_subtrees();
+        } else {
+            child->clear_layout_dirty_subtree();
+        }
     }
 }
 
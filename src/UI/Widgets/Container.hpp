@@ -25,11 +25,15 @@ public:
     void collect_focusable_widgets(std::vector<Widget*>& out_list);
 
     virtual void layout() override;
-    bool subtree_layout_dirty() const override;
+    bool is_opaque_in(const IntRect& rect) const override;
     void clear_layout_dirty_subtree() override;
+    void layout_dirty_subtrees() override;
     bool has_running_animations() const override;
 
 protected:
+    /* Index of the topmost child covering the whole clip, the ones below it are hidden */
+    size_t first_unoccluded_child(const Painter& painter) const;
+
     std::vector<std::unique_ptr<Widget>> m_children;
     Widget* m_captured_child = nullptr;
 };
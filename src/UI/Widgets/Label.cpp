@@ -8,6 +8,7 @@
 
 #include "Core/Application.hpp"
 #include "Core/ThemeDB.hpp"
+#include "Core/ViewManager.hpp"
 #include "Graphics/Font.hpp"
 #include "Graphics/Painter.hpp"
 #include "Input/Input.hpp"
@@ -375,6 +376,7 @@ void Label::update() {
             m_cursor_visible = !m_cursor_visible;
             m_cursor_timer = 0.0f;
         }
+        ViewManager::the().schedule_update(static_cast<float>(m_cursor_blink_speed_ms) - m_cursor_timer);
     } else {
         m_cursor_visible = false;
         m_cursor_timer = 0.0f;
@@ -691,7 +693,7 @@ bool Label::is_scrollable() const {
     return m_selecting;
 }
 
-void Label::measure(int parent_w, int parent_h) {
+void Label::measure_content(int parent_w, int parent_h) {
     int mw = 0, mh = 0;
     if (m_font) {
         int wrap_w = -1;
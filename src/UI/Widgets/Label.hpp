@@ -19,7 +19,7 @@ public:
     const std::string& text() const { return m_text; }
 
     void draw_content(Painter& painter) override;
-    void measure(int parent_w, int parent_h) override;
+    void measure_content(int parent_w, int parent_h) override;
     bool on_touch_event(IntPoint point, bool down) override;
     bool on_key(KeyCode key) override;
     bool is_scrollable() const override;
@@ -5,6 +5,8 @@
 #include "Input/Input.hpp"
 #include "Graphics/Painter.hpp"
 
+#include <algorithm>
+
 namespace Izo {
 
 ListBox::ListBox() {
@@ -20,6 +22,8 @@ void ListBox::on_theme_update() {
     m_color_border = ThemeDB::the().get<Color>("Colors", "ListBox.Border", Color(200));
     m_color_listitem_focus = ThemeDB::the().get<Color>("Colors", "ListItem.Focus", Color(0, 0, 255));
     m_widget_roundness = ThemeDB::the().get<int>("WidgetParams", "Widget.Roundness", 6);
+    // A full theme update also drops the measure caches of the items
+    m_measure_all_items = true;
     invalidate_visual();
 }
 
@@ -30,16 +34,33 @@ void ListBox::set_item_height(int h) {
 }
 
 void ListBox::add_item(std::unique_ptr<Widget> item) {
+    if (!item) return;
+    sync_item_offsets();
+    m_item_offsets.push_back(item->visible() ? m_item_height : 0);
     add_child(std::move(item));
 }
 
+/* Items added through add_child() bypass add_item(), so catch up
+   with estimated heights until the next measure pass. */
+void ListBox::sync_item_offsets() {
+    if (m_item_offsets.size() != m_children.size()) {
+        m_item_offsets.resize(m_children.size(), m_item_height);
+    }
+}
+
 void ListBox::smooth_scroll_to_index(int index) {
     if (index < 0 || index >= (int)m_children.size()) return;
-    const auto& listitem = m_children[index];
-    // Use local bounds to avoid compounding scroll offsets.
-    float listitem_offset = (float)(listitem->local_bounds().y - local_bounds().y);
-    float listitem_h = (float)listitem->local_bounds().h;
+
     float listview_h = (float)local_bounds().h;
+    if (listview_h <= 0.0f) {
+        // Not laid out yet, scroll once we know the viewport size.
+        m_pending_scroll_index = index;
+        return;
+    }
+
+    sync_item_offsets();
+    float listitem_offset = (float)m_item_offsets.offset_of(index);
+    float listitem_h = (float)m_item_offsets.extent(index);
     float target_y_pos = m_scroll_y;
 
     if (listitem_offset < -m_scroll_y) {
@@ -53,21 +74,27 @@ void ListBox::smooth_scroll_to_index(int index) {
 
 void ListBox::select(int index) {
     if (index < 0 || index >= (int)m_children.size()) {
-        m_selected_index = -1;
-        invalidate_visual();
-        return;
+        index = -1;
     }
     if (m_selected_index == index) return;
-    m_selected_index = index;
-    
-    for (size_t i = 0; i < m_children.size(); ++i) {
-        ListItem* listItem = dynamic_cast<ListItem*>(m_children[i].get());
-        if (listItem) {
-            listItem->set_selected((int)i == m_selected_index);
+
+    if (m_selected_index >= 0 && m_selected_index < (int)m_children.size()) {
+        if (auto* previous = dynamic_cast<ListItem*>(m_children[m_selected_index].get())) {
+            previous->set_selected(false);
         }
     }
+
+    m_selected_index = index;
+    if (m_selected_index < 0) {
+        invalidate_visual();
+        return;
+    }
+
+    if (auto* current = dynamic_cast<ListItem*>(m_children[m_selected_index].get())) {
+        current->set_selected(true);
+    }
     
-    if (m_on_item_selected && m_selected_index >= 0) {
+    if (m_on_item_selected) {
         m_on_item_selected(m_selected_index);
     }
 
@@ -75,17 +102,39 @@ void ListBox::select(int index) {
     invalidate_visual();
 }
 
-void ListBox::measure(int parent_w, int parent_h) {
+void ListBox::measure_content(int parent_w, int parent_h) {
     int w = parent_w;
     int h = parent_h;
     
-    int content_h = 0;
-    for (auto& child : m_children) {
-        if (!child->visible()) continue;
-        child->measure(parent_w, parent_h);
-        content_h += child->measured_height();
+    // An item keeps its height until it or something inside it changes.
+    // New constraints only mark the items stale, their last heights stay
+    // in the index as estimates until they come into view.
+    sync_item_offsets();
+    const bool constraints_changed = m_measure_all_items || parent_w != m_items_measured_w ||
+                                     parent_h != m_items_measured_h;
+    if (constraints_changed) {
+        m_item_measured.assign(m_children.size(), false);
+    } else {
+        m_item_measured.resize(m_children.size(), false);
     }
-    m_total_content_height = content_h;
+
+    // Off-screen items are only checked, not measured. Hidden ones take no
+    // space wherever they are.
+    for (size_t i = 0; i < m_children.size(); ++i) {
+        auto& child = m_children[i];
+        if (!child->visible()) {
+            m_item_offsets.set(i, 0);
+            m_item_measured[i] = true;
+        } else if (child->subtree_layout_dirty()) {
+            m_item_measured[i] = false;
+        }
+    }
+
+    m_measure_all_items = false;
+    m_items_measured_w = parent_w;
+    m_items_measured_h = parent_h;
+    measure_items_in_view(m_bounds.h > 0 ? m_bounds.h : parent_h);
+    int content_h = m_item_offsets.total();
 
     if (m_width == (int)WidgetSizePolicy::MatchParent) w = parent_w;
     else if (m_width == (int)WidgetSizePolicy::WrapContent) w = 200;
@@ -98,78 +147,166 @@ void ListBox::measure(int parent_w, int parent_h) {
     m_measured_size = {0, 0, w, h};
 }
 
-void ListBox::layout_children() {
-    int cur_y = m_bounds.y;
-    int idx = 0;
-    for (auto& child : m_children) {
-        if (!child->visible()) continue;
-        child->set_layout_index(idx++);
-        int ch = child->measured_height();
-        child->set_bounds({m_bounds.x, cur_y, m_bounds.w, ch});
-        child->layout();
-        cur_y += ch;
+void ListBox::on_measure_restored(int parent_w, int parent_h) {
+    // The offsets still hold the item heights of the other constraints, the
+    // items in view hit the caches the replay just restored
+    m_measure_all_items = true;
+    measure_content(parent_w, parent_h);
+}
+
+/* Items overlapping the viewport plus a small margin, the rest of the list
+   is neither measured nor laid out until it scrolls into view */
+void ListBox::item_range_in_view(int view_h, size_t& first, size_t& last) const {
+    first = last = 0;
+    if (m_children.empty() || m_item_offsets.empty()) return;
+
+    // Without a height yet, e.g. inside a wrapping parent, all items are in view
+    if (view_h <= 0) {
+        last = m_item_offsets.size();
+        return;
     }
+
+    int view_top = (int)-m_scroll_y;
+    first = m_item_offsets.index_at(view_top - kItemViewMargin);
+    last = std::min(m_item_offsets.index_at(view_top + view_h + kItemViewMargin) + 1, m_item_offsets.size());
 }
 
-bool ListBox::on_key(KeyCode key) {
-    if (!m_focused) return false;
+bool ListBox::measure_items_in_view(int view_h) {
+    // Measured heights move the items below, so the range is re-read as it grows
+    bool resized = false;
+    size_t first, last;
+    item_range_in_view(view_h, first, last);
+    for (size_t i = first; i < last; ++i) {
+        if (m_item_measured[i]) continue;
 
-    auto first_visible_index = [this]() -> int {
-        for (int i = 0; i < (int)m_children.size(); ++i) {
-            auto& c = m_children[i];
-            if (!c->visible()) continue;
-            int item_content_y = c->local_bounds().y - m_bounds.y;
-            float view_y = (float)item_content_y + m_scroll_y;
-            if (view_y + (float)c->local_bounds().h > 0.0f) {
-                return i;
-            }
+        auto& child = m_children[i];
+        int item_h = 0;
+        if (child->visible()) {
+            child->measure(m_items_measured_w, m_items_measured_h);
+            item_h = child->measured_height();
         }
-        return m_children.empty() ? -1 : 0;
-    };
-
-    auto page_step = [this](int start_index, int direction) -> int {
-        if (m_children.empty()) return 0;
-        float view_h = (float)local_bounds().h;
-        if (view_h <= 0.0f) return 1;
-
-        float accum = 0.0f;
-        int step = 0;
-        if (direction > 0) {
-            for (int i = start_index; i < (int)m_children.size(); ++i) {
-                auto& c = m_children[i];
-                if (!c->visible()) continue;
-                float h = (float)c->local_bounds().h;
-                if (step > 0 && accum + h > view_h) break;
-                accum += h;
-                ++step;
-            }
+        m_item_measured[i] = true;
+        if (item_h != m_item_offsets.extent(i)) {
+            m_item_offsets.set(i, item_h);
+            resized = true;
+            item_range_in_view(view_h, first, last);
+        }
+    }
+    return resized;
+}
+
+void ListBox::layout_items_in_view(bool force) {
+    size_t first, last;
+    item_range_in_view(m_bounds.h, first, last);
+
+    // Items that left the view keep no area, so stale bounds never catch touches
+    for (size_t i = m_laid_out_first; i < std::min(m_laid_out_last, m_children.size()); ++i) {
+        if (i >= first && i < last) continue;
+        auto& child = m_children[i];
+        child->set_bounds({m_bounds.x, m_bounds.y + m_item_offsets.offset_of(i), m_bounds.w, 0});
+    }
+
+    for (size_t i = first; i < last; ++i) {
+        auto& child = m_children[i];
+        if (!child->visible()) continue;
+        child->set_layout_index((int)i);
+
+        IntRect item_bounds{m_bounds.x, m_bounds.y + m_item_offsets.offset_of(i), m_bounds.w, m_item_offsets.extent(i)};
+        bool was_laid_out = i >= m_laid_out_first && i < m_laid_out_last;
+        if (force || !was_laid_out || child->local_bounds() != item_bounds) {
+            child->set_bounds(item_bounds);
+            child->layout();
+        }
+    }
+
+    m_laid_out_first = first;
+    m_laid_out_last = last;
+}
+
+void ListBox::layout_children() {
+    sync_item_offsets();
+    m_item_measured.resize(m_children.size(), false);
+    // The view height may have changed since the measure pass
+    measure_items_in_view(m_bounds.h);
+    layout_items_in_view(true);
+
+    if (m_pending_scroll_index >= 0 && m_bounds.h > 0) {
+        int index = m_pending_scroll_index;
+        m_pending_scroll_index = -1;
+        smooth_scroll_to_index(index);
+    }
+}
+
+void ListBox::update() {
+    Layout::update();
+    // Not measured yet, the first layout pass covers the view
+    if (m_items_measured_w < 0 || m_bounds.h <= 0) return;
+
+    sync_item_offsets();
+    m_item_measured.resize(m_children.size(), false);
+    bool resized = measure_items_in_view(m_bounds.h);
+
+    size_t first, last;
+    item_range_in_view(m_bounds.h, first, last);
+    if (!resized && first == m_laid_out_first && last == m_laid_out_last) return;
+
+    layout_items_in_view(false);
+    if (resized) {
+        if (m_height == (int)WidgetSizePolicy::WrapContent) {
+            invalidate_layout();
         } else {
-            for (int i = start_index; i >= 0; --i) {
-                auto& c = m_children[i];
-                if (!c->visible()) continue;
-                float h = (float)c->local_bounds().h;
-                if (step > 0 && accum + h > view_h) break;
-                accum += h;
-                ++step;
-            }
+            invalidate_scrollbar();
         }
+    }
+}
+
+int ListBox::first_visible_index() const {
+    const int count = (int)m_item_offsets.size();
+    if (m_children.empty() || count == 0) return -1;
+
+    // Hidden items take no space, index_at() may still land on one
+    int index = (int)m_item_offsets.index_at((int)-m_scroll_y);
+    for (int i = index; i < count; ++i) {
+        if (m_item_offsets.extent(i) > 0) return i;
+    }
+    for (int i = index - 1; i >= 0; --i) {
+        if (m_item_offsets.extent(i) > 0) return i;
+    }
+    return -1;
+}
+
+/* Index one page away from start_index, using the same rule as before:
+   the first item that doesn't fully fit in the viewport. */
+int ListBox::page_target_index(int start_index, int direction) const {
+    int count = (int)m_item_offsets.size();
+    if (count == 0) return 0;
+    start_index = std::clamp(start_index, 0, count - 1);
+
+    int view_h = local_bounds().h;
+    if (view_h <= 0) return std::clamp(start_index + direction, 0, count - 1);
+
+    int target = start_index;
+    if (direction > 0) {
+        int start_offset = m_item_offsets.offset_of(start_index);
+        target = (int)m_item_offsets.index_at(start_offset + view_h);
+        if (target <= start_index) target = start_index + 1;
+    } else {
+        int end_offset = m_item_offsets.offset_of(start_index) + m_item_offsets.extent(start_index);
+        target = (int)m_item_offsets.index_at(end_offset - view_h - 1);
+        if (target >= start_index) target = start_index - 1;
+    }
+
+    return std::clamp(target, 0, count - 1);
+}
+
+bool ListBox::on_key(KeyCode key) {
+    if (!m_focused) return false;
+
+    sync_item_offsets();
 
-        return step > 0 ? step : 1;
-    };
-    
     if (key == KeyCode::Down) {
         if (m_selected_index == -1) {
-            for(int i=0; i<(int)m_children.size(); ++i) {
-                auto& c = m_children[i];
-                if (!c->visible()) continue;
-                int item_content_y = c->local_bounds().y - m_bounds.y;
-                float view_y = (float)item_content_y + m_scroll_y;
-                if (view_y + (float)c->local_bounds().h > 0.0f) {
-                    select(i);
-                    return true;
-                }
-            }
-            if(!m_children.empty()) select(0);
+            if (!m_children.empty()) select(first_visible_index());
         } else {
             int next = m_selected_index + 1;
             if (next < (int)m_children.size()) {
@@ -184,17 +321,7 @@ bool ListBox::on_key(KeyCode key) {
                 select(prev);
             }
         } else {
-             for(int i=0; i<(int)m_children.size(); ++i) {
-                auto& c = m_children[i];
-                if (!c->visible()) continue;
-                int item_content_y = c->local_bounds().y - m_bounds.y;
-                float view_y = (float)item_content_y + m_scroll_y;
-                if (view_y + (float)c->local_bounds().h > 0.0f) {
-                    select(i);
-                    return true;
-                }
-             }
-             if(!m_children.empty()) select(0);
+            if (!m_children.empty()) select(first_visible_index());
         }
         return true;
     } else if (key == KeyCode::Home) {
@@ -209,19 +336,13 @@ bool ListBox::on_key(KeyCode key) {
         if (m_children.empty()) return false;
         int current = m_selected_index >= 0 ? m_selected_index : first_visible_index();
         if (current < 0) return false;
-        int step = page_step(current, 1);
-        int target = current + step;
-        if (target >= (int)m_children.size()) target = (int)m_children.size() - 1;
-        select(target);
+        select(page_target_index(current, 1));
         return true;
     } else if (key == KeyCode::PageUp) {
         if (m_children.empty()) return false;
         int current = m_selected_index >= 0 ? m_selected_index : first_visible_index();
         if (current < 0) return false;
-        int step = page_step(current, -1);
-        int target = current - step;
-        if (target < 0) target = 0;
-        select(target);
+        select(page_target_index(current, -1));
         return true;
     }
     
@@ -242,7 +363,7 @@ bool ListBox::on_scroll(int y) {
                 if (m_velocity_y > MAX_V) m_velocity_y = MAX_V;
                 if (m_velocity_y < -MAX_V) m_velocity_y = -MAX_V;
                 m_scrollbar_alpha = 255;
-                invalidate_visual();
+                invalidate_scrollbar();
                 return true;
             }
         }
@@ -259,8 +380,15 @@ void ListBox::draw_content(Painter& painter) {
     int visible_bottom = bounds.y + bounds.h;
     painter.push_rounded_clip(bounds, m_widget_roundness);
 
+    // Only walk the items overlapping the viewport, the ones laid out
+    int margin = kItemViewMargin;
+    sync_item_offsets();
+    size_t first_index = 0;
+    size_t last_index = 0;
+    item_range_in_view(bounds.h, first_index, last_index);
+
     // Selection background should render below item content.
-    for (size_t i = 0; i < m_children.size(); ++i) {
+    for (size_t i = first_index; i < last_index; ++i) {
         auto& child = m_children[i];
         if (!child->visible()) continue;
         
@@ -279,10 +407,10 @@ void ListBox::draw_content(Painter& painter) {
     }
 
     // Draw children (clipped to rounded bounds).
-    int margin = 10;
     int child_visible_top = bounds.y - margin;
     int child_visible_bottom = bounds.y + bounds.h + margin;
-    for (auto& child : m_children) {
+    for (size_t i = first_index; i < last_index; ++i) {
+        auto& child = m_children[i];
         if (!child->visible()) continue;
 
         IntRect child_bounds = child->global_bounds();
@@ -292,7 +420,7 @@ void ListBox::draw_content(Painter& painter) {
     }
 
     // Dividers on top of items.
-    for (size_t i = 0; i < m_children.size(); ++i) {
+    for (size_t i = first_index; i < last_index; ++i) {
         auto& child = m_children[i];
         if (!child->visible()) continue;
         IntRect cb = child->global_bounds();
@@ -1,7 +1,9 @@
 #pragma once
 
 #include "UI/Layout/Layout.hpp"
+#include "UI/Layout/OffsetIndex.hpp"
 #include "Graphics/Color.hpp"
+#include <algorithm>
 #include <functional>
 
 namespace Izo {
@@ -18,7 +20,9 @@ public:
 
     void draw_content(Painter& painter) override;
     void layout_children() override;
-    void measure(int parent_w, int parent_h) override;
+    void measure_content(int parent_w, int parent_h) override;
+    void update() override;
+    bool is_opaque_in(const IntRect& rect) const override { return rounded_background_covers(rect, m_widget_roundness, m_color_bg); }
     bool on_key(KeyCode key) override;
     void smooth_scroll_to_index(int index) override;
     bool on_scroll(int y) override;
@@ -30,11 +34,34 @@ public:
     void on_item_selected(std::function<void(int)> cb) { m_on_item_selected = cb; }
 
 protected:
-    int content_height() const override { return m_total_content_height; }
+    int content_height() const override { return m_item_offsets.total(); }
+    void on_measure_restored(int parent_w, int parent_h) override;
+    /* The rounded corners and border stay in place while the items scroll */
+    int scroll_blit_inset() const override { return std::max(Layout::scroll_blit_inset(), m_widget_roundness + 1); }
 
 private:
+    void sync_item_offsets();
+    void item_range_in_view(int view_h, size_t& first, size_t& last) const;
+    /* Measures the stale items in view, true if any height changed */
+    bool measure_items_in_view(int view_h);
+    /* force lays out every item in view, otherwise only new and moved ones */
+    void layout_items_in_view(bool force);
+    int first_visible_index() const;
+    int page_target_index(int start_index, int direction) const;
+
     int m_item_height = 50; 
-    int m_total_content_height = 0;
+    OffsetIndex m_item_offsets;
+    static constexpr int kItemViewMargin = 10;
+
+    // Constraints of the last measure pass, items measured for them are marked
+    int m_items_measured_w = -1;
+    int m_items_measured_h = -1;
+    std::vector<bool> m_item_measured;
+    bool m_measure_all_items = true;
+    // Items laid out by the last layout_items_in_view()
+    size_t m_laid_out_first = 0;
+    size_t m_laid_out_last = 0;
+    int m_pending_scroll_index = -1;
     int m_selected_index = -1;
     std::function<void(int)> m_on_item_selected;
     Color m_color_bg{10, 10, 10};
@@ -235,6 +235,7 @@ void OptionBox::on_theme_update() {
 
 void OptionBox::add_option(const std::string& option) {
     m_options.push_back(option);
+    invalidate_layout();
 }
 
 void OptionBox::set_options(const std::vector<std::string>& options) {
@@ -259,7 +260,7 @@ void OptionBox::set_anim_variant(AnimationVariant variant) {
     invalidate_layout();
 }
 
-void OptionBox::measure(int parent_w, int parent_h) {
+void OptionBox::measure_content(int parent_w, int parent_h) {
     int total_text_width = 0;
     int total_text_height = m_font ? m_font->height() : 20;
 
@@ -28,7 +28,9 @@ public:
     void draw_content(Painter& painter) override;
     void update() override;
     bool on_touch_event(IntPoint point, bool down) override;
-    void measure(int parent_w, int parent_h) override;
+    void measure_content(int parent_w, int parent_h) override;
+    bool is_relayout_boundary() const override { return false; }
+    bool is_opaque_in(const IntRect& rect) const override { return rounded_background_covers(rect, m_roundness, m_bg_anim.value()); }
     void on_theme_update() override;
 
     void add_option(const std::string& option);
@@ -25,7 +25,7 @@ void OptionItem::on_theme_update() {
     invalidate_visual();
 }
 
-void OptionItem::measure(int parent_w, int parent_h) {
+void OptionItem::measure_content(int parent_w, int parent_h) {
     if (!m_font) return;
     int h = m_font->height() + m_padding.top + m_padding.bottom;
     m_measured_size = {0, 0, parent_w, h};
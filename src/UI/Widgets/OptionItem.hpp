@@ -14,7 +14,7 @@ public:
     void draw_content(Painter& painter) override;
     void update() override;
     bool on_touch_event(IntPoint point, bool down) override;
-    void measure(int parent_w, int parent_h) override;
+    void measure_content(int parent_w, int parent_h) override;
     void on_theme_update() override;
 
     void set_selected(bool selected);
@@ -157,7 +157,7 @@ void ProgressBar::update() {
     }
 }
 
-void ProgressBar::measure(int parent_w, int parent_h) {
+void ProgressBar::measure_content(int parent_w, int parent_h) {
     m_measured_size = {0, 0, 100, height()};
 }
 
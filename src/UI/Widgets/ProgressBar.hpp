@@ -31,7 +31,7 @@ public:
     AnimationVariant animation_variant() const { return m_variant; }
 
     void draw_content(Painter& painter) override;
-    void measure(int parent_w, int parent_h) override;
+    void measure_content(int parent_w, int parent_h) override;
     bool on_touch_event(IntPoint point, bool down) override;
     void update() override;
     void on_theme_update() override;
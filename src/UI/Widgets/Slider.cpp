@@ -10,8 +10,8 @@
 namespace Izo {
 
 Slider::Slider(float value) : m_value(value) {
-    m_img_handle        = ImageManager::the().get_or_crash("slider-handle");
-    m_img_handle_focus  = ImageManager::the().get_or_crash("slider-handle-focus");
+    m_img_handle        = ImageManager::the().acquire("slider-handle");
+    m_img_handle_focus  = ImageManager::the().acquire("slider-handle-focus");
 
     set_focusable(true);
     set_show_focus_indicator(false);
@@ -47,9 +47,9 @@ void Slider::draw_content(Painter& painter) {
     int ty = bounds.y + (bounds.h - track_h) / 2;
 
     int hw = 16;
-    Image* imgToDraw = m_img_handle;
+    Image* imgToDraw = m_img_handle.get();
     if (m_pressed && m_img_handle_focus && m_img_handle_focus->valid()) {
-        imgToDraw = m_img_handle_focus;
+        imgToDraw = m_img_handle_focus.get();
     }
     if (imgToDraw && imgToDraw->valid()) {
         hw = imgToDraw->width();
@@ -79,7 +79,7 @@ void Slider::draw_content(Painter& painter) {
     }
 }
 
-void Slider::measure(int parent_w, int parent_h) {
+void Slider::measure_content(int parent_w, int parent_h) {
     m_measured_size = {0, 0, 150, 40};
 }
 
@@ -88,8 +88,8 @@ bool Slider::on_touch_event(IntPoint point, bool down) {
 
     int hw = 16, hh = 16;
 
-    Image* img = m_img_handle;
-    if ((m_pressed || m_focused) && m_img_handle_focus && m_img_handle_focus->valid()) img = m_img_handle_focus;
+    Image* img = m_img_handle.get();
+    if ((m_pressed || m_focused) && m_img_handle_focus && m_img_handle_focus->valid()) img = m_img_handle_focus.get();
 
     if (img && img->valid()) {
         hw = img->width();
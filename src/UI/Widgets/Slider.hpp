@@ -1,12 +1,11 @@
 #pragma once
 
 #include "UI/Widgets/Widget.hpp"
+#include "Graphics/Image.hpp"
 #include <functional>
 
 namespace Izo {
 
-class Image;
-
 class Slider : public Widget {
 public:
     Slider(float value = 0.0f);
@@ -17,7 +16,7 @@ public:
     void set_on_change(std::function<void(float)> callback) { m_on_change = callback; }
 
     void draw_content(Painter& painter) override;
-    void measure(int parent_w, int parent_h) override;
+    void measure_content(int parent_w, int parent_h) override;
     bool on_touch_event(IntPoint point, bool down) override;
     void on_theme_update() override;
 
@@ -25,8 +24,8 @@ private:
     float m_value;
     int m_roundness = 6;
     bool m_pressed = false;
-    Image* m_img_handle;
-    Image* m_img_handle_focus;
+    ImageManager::Handle m_img_handle;
+    ImageManager::Handle m_img_handle_focus;
     std::function<void(float)> m_on_change;
     Color m_color_track{90, 90, 90};
     Color m_color_active{90, 90, 90};
@@ -3,6 +3,7 @@
 #include "Core/ThemeDB.hpp"
 #include "Input/Input.hpp"
 #include "Core/Application.hpp"
+#include "Core/ViewManager.hpp"
 #include <algorithm>
 #include <cmath>
 #include <cctype>
@@ -187,6 +188,7 @@ void TextBox::update() {
             m_cursor_visible = !m_cursor_visible;
             m_cursor_timer = 0.0f;
         }
+        ViewManager::the().schedule_update((float)m_cursor_blink_speed_ms - m_cursor_timer);
 
         if (m_is_dragging) {
             IntPoint mouse = Input::the().touch_point();
@@ -396,7 +398,7 @@ bool TextBox::on_key(KeyCode key) {
     return true;
 }
 
-void TextBox::measure(int parent_w, int parent_h) {
+void TextBox::measure_content(int parent_w, int parent_h) {
     int mh = m_font ? m_font->height() + 10 : 30;
     int mw = 200;
 
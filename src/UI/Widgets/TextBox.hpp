@@ -26,7 +26,10 @@ public:
     void update() override;
     bool on_touch_event(IntPoint point, bool down) override;
     bool on_key(KeyCode key) override;
-    void measure(int parent_w, int parent_h) override;
+    void measure_content(int parent_w, int parent_h) override;
+    /* The size never depends on the text, so typing does not relayout the parent */
+    bool is_relayout_boundary() const override { return true; }
+    bool is_opaque_in(const IntRect& rect) const override { return rounded_background_covers(rect, m_roundness, m_color_bg); }
     void on_theme_update() override;
     bool has_running_animations() const override;
 
@@ -65,19 +65,24 @@ void Toast::draw(Painter& painter, int screen_width, int screen_height) {
     // Grows upwards means the y position depends on height.
     int y = screen_height - m_height - 100;
 
-    Color bg = ThemeDB::the().get<Color>("Colors", "Toast.Background", Color(100));
+    static const ThemeKey k_background{"Colors", "Toast.Background"};
+    Color bg = ThemeDB::the().get<Color>(k_background, Color(100));
     bg.a = (uint8_t)(bg.a * m_alpha);
     
-    int roundness = ThemeDB::the().get<int>("WidgetParams", "Toast.Roundness", 12);
-    int border_thickness = ThemeDB::the().get<int>("WidgetParams", "Toast.BorderThickness", 12);
+    static const ThemeKey k_roundness{"WidgetParams", "Toast.Roundness"};
+    int roundness = ThemeDB::the().get<int>(k_roundness, 12);
+    static const ThemeKey k_border_thickness{"WidgetParams", "Toast.BorderThickness"};
+    int border_thickness = ThemeDB::the().get<int>(k_border_thickness, 12);
 
     painter.fill_rounded_rect({x, y, m_width, m_height}, roundness, bg);
     
-    Color border = ThemeDB::the().get<Color>("Colors", "Toast.Border", Color(50));
+    static const ThemeKey k_border{"Colors", "Toast.Border"};
+    Color border = ThemeDB::the().get<Color>(k_border, Color(50));
     border.a = (uint8_t)(border.a * m_alpha);
     painter.draw_rounded_rect({x, y, m_width, m_height}, roundness, border, border_thickness);
     
-    Color text_c = ThemeDB::the().get<Color>("Colors", "Toast.Text", Color(0));
+    static const ThemeKey k_text{"Colors", "Toast.Text"};
+    Color text_c = ThemeDB::the().get<Color>(k_text, Color(0));
     text_c.a = (uint8_t)(text_c.a * m_alpha);
     
     // Draw text centered in the toast
@@ -5,11 +5,10 @@
 #include <queue>
 #include <functional>
 
-#include <functional>
+#include "Graphics/Font.hpp"
 
 namespace Izo {
 
-class Font;
 class Painter;
 
 class Toast {
@@ -30,7 +29,7 @@ public:
     
 private:
     std::string m_message;
-    Font* m_font;
+    FontManager::Handle m_font;
     int m_duration_ms;
     State m_state;
     float m_timer;
@@ -52,14 +51,14 @@ public:
     void update();
     void draw(class Painter& painter, int screen_width, int screen_height);
     
-    void set_font(Font* font) { m_font = font; }
-    Font* font() const { return m_font; }
+    void set_font(FontManager::Handle font) { m_font = std::move(font); }
+    const FontManager::Handle& font() const { return m_font; }
     bool has_active_toast() const { return m_current != nullptr || !m_queue.empty(); }
 
 private:
     ToastManager() = default;
     
-    Font* m_font = nullptr;
+    FontManager::Handle m_font;
     std::queue<std::unique_ptr<Toast>> m_queue;
     std::unique_ptr<Toast> m_current;
 };
@@ -1,6 +1,8 @@
 #include "UI/Widgets/Widget.hpp"
 
 #include <algorithm>
+#include <typeindex>
+#include <unordered_map>
 #include <vector>
 
 #include "Core/Application.hpp"
@@ -29,15 +31,73 @@ Widget::~Widget() {
     widgets.erase(std::remove(widgets.begin(), widgets.end(), this), widgets.end());
 }
 
+// Theme keys read by on_theme_update() of each widget class. Those reads
+// use fixed keys, so one set per class covers every instance.
+static std::unordered_map<std::type_index, std::vector<uint32_t>>& theme_dependencies() {
+    static std::unordered_map<std::type_index, std::vector<uint32_t>> s_dependencies;
+    return s_dependencies;
+}
+
+void Widget::run_tracked_theme_update() {
+    std::vector<uint32_t> reads;
+    ThemeDB::the().set_read_log(&reads);
+    on_theme_update();
+    ThemeDB::the().set_read_log(nullptr);
+
+    auto& keys = theme_dependencies()[std::type_index(typeid(*this))];
+    keys.insert(keys.end(), reads.begin(), reads.end());
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+}
+
 void Widget::notify_theme_update_all() {
     auto widgets = widget_registry();
     for (auto* widget : widgets) {
         if (widget) {
-            widget->on_theme_update();
+            widget->run_tracked_theme_update();
+        }
+    }
+
+    // Fonts and metrics may have changed anywhere, relayout every tree fully
+    for (auto* widget : widgets) {
+        if (!widget) continue;
+        widget->clear_measure_cache();
+        if (!widget->parent()) {
+            widget->invalidate_layout();
         }
     }
 }
 
+void Widget::notify_theme_keys_changed() {
+    const ThemeDB& theme = ThemeDB::the();
+    auto& dependencies = theme_dependencies();
+    std::unordered_map<std::type_index, bool> class_affected;
+
+    auto widgets = widget_registry();
+    size_t updated = 0;
+    for (auto* widget : widgets) {
+        if (!widget) continue;
+
+        std::type_index type(typeid(*widget));
+        auto affected_it = class_affected.find(type);
+        if (affected_it == class_affected.end()) {
+            // Classes that never ran a tracked update have unknown dependencies
+            auto deps_it = dependencies.find(type);
+            bool affected = deps_it == dependencies.end() ||
+                std::any_of(deps_it->second.begin(), deps_it->second.end(),
+                            [&](uint32_t id) { return theme.key_changed(id); });
+            affected_it = class_affected.emplace(type, affected).first;
+        }
+        if (!affected_it->second) continue;
+
+        widget->run_tracked_theme_update();
+        widget->invalidate_layout();
+        ++updated;
+    }
+
+    LogDebug("Theme update refreshed {} of {} widgets", updated, widgets.size());
+}
+
 void Widget::draw(Painter& painter) {
     if (!m_visible) return;
     draw_content(painter);
@@ -67,7 +127,7 @@ void Widget::draw_debug_info(Painter& painter) {
 }
 
 void Widget::on_theme_update() {
-    m_font = FontManager::the().get_or_crash("system-ui");
+    m_font = FontManager::the().acquire_or_crash("system-ui");
     m_focus_outline_thickness = ThemeDB::the().get<int>("WidgetParams", "Widget.FocusThickness", 12);
     m_focus_roundness = ThemeDB::the().get<int>("WidgetParams", "Widget.Roundness", 6);
     m_focus_color = ThemeDB::the().get<Color>("Colors", "Widget.Focus", Color(0, 0, 255));
@@ -75,13 +135,72 @@ void Widget::on_theme_update() {
 }
 
 void Widget::update() {
+    bool was_running = m_focus_anim.running();
     m_focus_anim.update(Application::the().delta());
-    if (m_focus_anim.running()) {
-        invalidate_visual();
+    if (was_running && m_visible) {
+        // The outline grows outside of the bounds while animating
+        IntRect b = global_bounds();
+        int e = m_focus_outline_thickness + 1;
+        ViewManager::the().invalidate_rect({b.x - e, b.y - e, b.w + e * 2, b.h + e * 2});
     }
 }
 
+thread_local std::vector<Widget::ChildMeasure>* Widget::s_child_measures = nullptr;
+
 void Widget::measure(int parent_w, int parent_h) {
+    m_last_measure_w = parent_w;
+    m_last_measure_h = parent_h;
+    if (s_child_measures) s_child_measures->push_back({this, parent_w, parent_h});
+
+    // A dirty descendant still has to be reached through measure_content()
+    if (!m_descendant_layout_dirty) {
+        for (int i = 0; i < m_measure_cache_count; ++i) {
+            const auto& entry = m_measure_cache[i];
+            if (entry.parent_w != parent_w || entry.parent_h != parent_h) continue;
+
+            m_measured_size = entry.size;
+            // The children were last measured for other constraints
+            if (i != m_measure_cache_latest) {
+                auto* outer = s_child_measures;
+                s_child_measures = nullptr;
+                for (const auto& call : entry.children) {
+                    call.child->measure(call.parent_w, call.parent_h);
+                }
+                on_measure_restored(parent_w, parent_h);
+                s_child_measures = outer;
+            }
+
+            m_measure_cache_latest = i;
+            return;
+        }
+    }
+
+    std::vector<ChildMeasure> children;
+    auto* outer = s_child_measures;
+    s_child_measures = &children;
+    measure_content(parent_w, parent_h);
+    s_child_measures = outer;
+
+    int slot = -1;
+    for (int i = 0; i < m_measure_cache_count; ++i) {
+        if (m_measure_cache[i].parent_w == parent_w && m_measure_cache[i].parent_h == parent_h) {
+            slot = i;
+            break;
+        }
+    }
+    if (slot < 0) {
+        if (m_measure_cache_count < kMeasureCacheSize) {
+            slot = m_measure_cache_count++;
+        } else {
+            slot = (m_measure_cache_latest + 1) % kMeasureCacheSize;
+        }
+    }
+
+    m_measure_cache[slot] = {parent_w, parent_h, m_measured_size, std::move(children)};
+    m_measure_cache_latest = slot;
+}
+
+void Widget::measure_content(int parent_w, int parent_h) {
     int w = 0, h = 0;
     if (m_width == (int)WidgetSizePolicy::MatchParent)
         w = parent_w;
@@ -168,16 +287,18 @@ bool Widget::hovering() const {
     return global_bounds().contains(Input::the().touch_point());
 }
 
-void Widget::set_font(Font* font) {
+void Widget::set_font(FontManager::Handle font) {
     if (m_font == font) return;
-    m_font = font;
+    m_font = std::move(font);
     invalidate_layout();
+    invalidate_parent_layout();
 }
 
 void Widget::show() {
     if (m_visible) return;
     m_visible = true;
     invalidate_layout();
+    invalidate_parent_layout();
 }
 
 void Widget::hide() {
@@ -186,6 +307,7 @@ void Widget::hide() {
     m_visible = false;
     ViewManager::the().invalidate_rect(old_bounds);
     invalidate_layout();
+    invalidate_parent_layout();
 }
 
 void Widget::set_bounds(const IntRect& new_bounds) {
@@ -211,6 +333,7 @@ void Widget::set_height(int new_height) {
 
     m_height = new_height;
     invalidate_layout();
+    invalidate_parent_layout();
 }
 
 void Widget::set_height(WidgetSizePolicy size_policy) {
@@ -223,6 +346,7 @@ void Widget::set_width(int new_width) {
 
     m_width = new_width;
     invalidate_layout();
+    invalidate_parent_layout();
 }
 
 void Widget::set_width(WidgetSizePolicy size_policy) {
@@ -279,13 +403,62 @@ void Widget::invalidate_visual() {
 }
 
 void Widget::invalidate_layout() {
-    if (!m_layout_dirty) {
-        m_layout_dirty = true;
-        if (m_parent) {
-            m_parent->invalidate_layout();
-        }
-    }
+    bool was_dirty = m_layout_dirty;
+    m_layout_dirty = true;
+    clear_measure_cache();
     invalidate_visual();
+
+    if (!m_parent) return;
+
+    if (is_relayout_boundary()) {
+        m_parent->mark_descendant_layout_dirty();
+    } else if (!was_dirty || !m_parent->layout_dirty()) {
+        m_parent->invalidate_layout();
+    }
+}
+
+/* Used when the widget's own size or visibility changes, which always
+   affects the parent regardless of relayout boundaries */
+void Widget::invalidate_parent_layout() {
+    if (m_parent) m_parent->invalidate_layout();
+}
+
+void Widget::mark_descendant_layout_dirty() {
+    if (m_descendant_layout_dirty) return;
+    m_descendant_layout_dirty = true;
+    if (m_parent) m_parent->mark_descendant_layout_dirty();
+}
+
+bool Widget::is_relayout_boundary() const {
+    return m_width != (int)WidgetSizePolicy::WrapContent &&
+           m_height != (int)WidgetSizePolicy::WrapContent;
+}
+
+void Widget::clear_layout_dirty_subtree() {
+    m_layout_dirty = false;
+    m_descendant_layout_dirty = false;
+}
+
+void Widget::layout_dirty_subtrees() {
+    if (m_layout_dirty) {
+        // Either the root of the pass or a relayout boundary, so the
+        // bounds assigned by the parent are still valid
+        measure(m_last_measure_w, m_last_measure_h);
+        layout();
+        clear_layout_dirty_subtree();
+        invalidate_visual();
+        return;
+    }
+    m_descendant_layout_dirty = false;
+}
+
+bool Widget::rounded_background_covers(const IntRect& rect, int radius, Color color) const {
+    if (!m_visible || color.a != 255) return false;
+
+    IntRect b = global_bounds();
+    int r = std::max(0, std::min(radius, std::min(b.w, b.h) / 2));
+    return IntRect{b.x + r, b.y, b.w - r * 2, b.h}.contains(rect) ||
+           IntRect{b.x, b.y + r, b.w, b.h - r * 2}.contains(rect);
 }
 
 bool Widget::has_running_animations() const {
@@ -1,15 +1,16 @@
 #pragma once
 
 #include <string>
+#include <vector>
 #include "Geometry/Primitives.hpp"
 #include "Graphics/Color.hpp"
+#include "Graphics/Font.hpp"
 #include "Input/KeyCode.hpp"
 #include "Motion/Animator.hpp"
 
 namespace Izo {
 
 class Painter;
-class Font;
 
 enum class WidgetSizePolicy {
     Fixed = 0,
@@ -23,6 +24,9 @@ public:
     virtual ~Widget();
 
     static void notify_theme_update_all();
+    /* Re-runs on_theme_update() only for widget classes that read a theme
+       key whose value changed in the last load */
+    static void notify_theme_keys_changed();
 
     virtual void draw_content(Painter& painter) = 0;
     virtual void draw_focus(Painter& painter); 
@@ -34,7 +38,10 @@ public:
     virtual void on_theme_update();
 
     virtual void layout() {};
-    virtual void measure(int parent_w, int parent_h); 
+    /* Records the constraints for partial relayout, then calls measure_content()
+       unless the size for these constraints is still cached */
+    void measure(int parent_w, int parent_h);
+    virtual void measure_content(int parent_w, int parent_h);
 
     /* What's the difference between on_touch and on_touch_event?? */
     virtual bool on_touch(IntPoint point, bool down, bool captured = false); 
@@ -46,6 +53,10 @@ public:
 
     virtual IntPoint content_scroll_offset() const { return {0, 0}; }
 
+    /* True if drawing the widget covers every pixel of rect (screen space)
+       with opaque colors, so whatever is beneath can be skipped */
+    virtual bool is_opaque_in(const IntRect& rect) const { (void)rect; return false; }
+
     /* Returns the widget bounds transformed with parent position and scroll position */
     const IntRect global_bounds() const;
     /* Returns the actual size and position of widget relative to it's parent */
@@ -55,8 +66,8 @@ public:
 
     void draw(Painter& painter); 
 
-    void set_font(Font* font);
-    Font* font() const { return m_font; }
+    void set_font(FontManager::Handle font);
+    Font* font() const { return m_font.get(); }
 
     int width() const { return m_width; }
     int height() const { return m_height; }
@@ -71,7 +82,7 @@ public:
     bool visible() const { return m_visible; }
     bool hovering() const;
 
-    void set_padding(Padding padding) { m_padding = padding; };
+    void set_padding(Padding padding) { set_padding_ltrb(padding.left, padding.top, padding.right, padding.bottom); };
     void set_padding_ltrb(int left, int top, int right, int bottom);
     const Padding padding() const { return m_padding; }
 
@@ -95,11 +106,19 @@ public:
     int layout_index() const { return m_layout_index; }
 
     void invalidate_visual();
+    /* Marks the widget for re-measure. Propagation to the ancestors stops at
+       relayout boundaries, which only flag the path down to themselves. */
     void invalidate_layout();
     bool layout_dirty() const { return m_layout_dirty; }
 
-    virtual bool subtree_layout_dirty() const { return m_layout_dirty; }
-    virtual void clear_layout_dirty_subtree() { m_layout_dirty = false; }
+    /* A widget whose measured size does not depend on its content. Changes
+       inside it never resize it, so its parent does not need a new layout. */
+    virtual bool is_relayout_boundary() const;
+
+    bool subtree_layout_dirty() const { return m_layout_dirty || m_descendant_layout_dirty; }
+    virtual void clear_layout_dirty_subtree();
+    /* Re-measures and lays out only the dirty parts of this subtree */
+    virtual void layout_dirty_subtrees();
     virtual bool has_running_animations() const;
 
     const std::string widget_type() const { return m_widget_type; };
@@ -107,7 +126,17 @@ protected:
     void handle_focus_logic(bool inside, bool down);
     void draw_focus_outline(Painter& painter);
     void draw_debug_info(Painter& painter);
+    /* Whether rect lies inside the widget's rounded background filled with color */
+    bool rounded_background_covers(const IntRect& rect, int radius, Color color) const;
     void set_widget_type(const std::string type) { m_widget_type = type; };
+    void invalidate_parent_layout();
+    void mark_descendant_layout_dirty();
+    void clear_measure_cache() { m_measure_cache_count = 0; }
+
+    /* A cache hit re-measures the children with the constraints they got
+       back then, which restores their sizes from their own caches. Widgets
+       that derive more state from the child sizes rebuild it here. */
+    virtual void on_measure_restored(int parent_w, int parent_h) { (void)parent_w; (void)parent_h; }
     void finalize_widget_construction() { on_theme_update(); }
 
     std::string m_widget_type;
@@ -129,12 +158,41 @@ protected:
     bool m_show_focus_indicator = true;
     Animator<float> m_focus_anim;
     Widget* m_parent = nullptr;
-    Font* m_font = nullptr;
+    FontManager::Handle m_font;
     int m_focus_outline_thickness = 12;
     int m_focus_roundness = 6;
     Color m_focus_color = Color(0, 0, 255);
     int m_focus_anim_duration = 300;
     bool m_layout_dirty = true;
+    bool m_descendant_layout_dirty = false;
+    int m_last_measure_w = 0;
+    int m_last_measure_h = 0;
+
+private:
+    /* Runs on_theme_update() and records the keys it read for this class */
+    void run_tracked_theme_update();
+
+    struct ChildMeasure {
+        Widget* child;
+        int parent_w;
+        int parent_h;
+    };
+
+    struct MeasureCacheEntry {
+        int parent_w;
+        int parent_h;
+        IntRect size;
+        std::vector<ChildMeasure> children;
+    };
+
+    // Child measurements of the measure_content() that is running, they are
+    // stored with its cache entry
+    static thread_local std::vector<ChildMeasure>* s_child_measures;
+
+    static constexpr int kMeasureCacheSize = 4;
+    MeasureCacheEntry m_measure_cache[kMeasureCacheSize];
+    int m_measure_cache_count = 0;
+    int m_measure_cache_latest = 0;
 };
 
 } 
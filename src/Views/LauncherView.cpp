@@ -135,7 +135,7 @@ class LauncherRoot : public Widget {
         invalidate_visual();
     }
 
-    void measure(int parent_w, int parent_h) override {
+    void measure_content(int parent_w, int parent_h) override {
         m_measured_size = {0, 0, parent_w, parent_h};
     }
 
@@ -10,23 +10,32 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <csignal>
 #include <cstdlib>
 #include <format>
 #include <iostream>
 #include <memory>
+#include <optional>
 #include <string>
-#include <thread>
 #include <vector>
 
 #include "Core/Application.hpp"
 #include "Core/ArgsParser.hpp"
+#include "Core/AssetWatcher.hpp"
+#include "Core/BootGraph.hpp"
+#include "Core/FrameScheduler.hpp"
+#include "Core/RenderThread.hpp"
 #include "Core/ResourceManager.hpp"
+#include "Core/ResourcePack.hpp"
 #include "Core/Settings.hpp"
 #include "Core/SystemStats.hpp"
+#include "Core/TaskPool.hpp"
 #include "Core/ThemeDB.hpp"
 #include "Core/ViewManager.hpp"
+#include "Debug/BootProfiler.hpp"
 #include "Debug/IzoShell.hpp"
 #include "Debug/IzoShellDialog.hpp"
 #include "Debug/Izometa.hpp"
@@ -59,6 +68,9 @@
 
 using namespace Izo;
 
+// Upper bound of the frame delta after the loop slept, about a frame
+static constexpr float kMaxIdleDeltaMs = 16.0f;
+
 void draw_debug_panel(Painter& painter, Font& font, float fps) {
     constexpr float kUpdateFrequency = 1.5f;  // every 1.5 seconds
     constexpr int kPanelRoundness = 20;
@@ -89,20 +101,67 @@ void draw_debug_panel(Painter& painter, Font& font, float fps) {
     font.draw_text(painter, {kPanelPadding + pos_x, 15}, cached_text, Color::White);
 }
 
+/* Runs an evdev recording through the decoder without bringing anything up
+   and prints the events it produced, one per line, in order. Used by
+   tools/input_replay.py to check the decoder against the fixtures. */
+static bool print_decoded_input(const std::string& path) {
+    // Every move is part of what the decoder produced
+    Settings::coalesce_touch_moves.set(false);
+    std::atomic<bool> running{true};
+    if (!replay_evdev_recording(path, false, running)) return false;
+
+    Input::the().poll_events();
+    InputEvent event;
+    while (Input::the().next_event(event)) {
+        switch (event.type) {
+            case InputEventType::TouchDown:
+                std::cout << std::format("TouchDown {} {}\n", event.point.x, event.point.y);
+                break;
+            case InputEventType::TouchMove:
+                std::cout << std::format("TouchMove {} {} {}\n", event.point.x, event.point.y, event.down ? 1 : 0);
+                break;
+            case InputEventType::TouchUp:
+                std::cout << std::format("TouchUp {} {}\n", event.point.x, event.point.y);
+                break;
+            case InputEventType::Key:
+                std::cout << std::format("Key {}\n", static_cast<int>(event.key));
+                break;
+            case InputEventType::Scroll:
+                std::cout << std::format("Scroll {}\n", event.scroll);
+                break;
+            case InputEventType::Modifiers:
+                std::cout << std::format("Modifiers {} {}\n", event.shift ? 1 : 0, event.ctrl ? 1 : 0);
+                break;
+        }
+    }
+    std::cout.flush();
+    return true;
+}
+
 const std::string try_parse_arguments(int argc, const char* argv[]) {
     // Set the default values of required arguments here
     std::string theme_name = "default";
     std::string resource_root = "res";
     std::string save_theme_preview;
+    std::string build_pack;
+    std::string replay_input;
+    std::string decode_input;
     bool debug_mode = false;
     bool flash_dirty_regions = false;
+    bool overdraw_heatmap = false;
+    bool triple_buffering = false;
 
     ArgsParser parser("Izotrox - Experimental GUI engine for Android and Linux");
     parser.add_argument(theme_name, "theme", "t", "Name of the theme to load", false);
     parser.add_argument(resource_root, "resource-root", "r", "Resource root directory", false);
     parser.add_argument(save_theme_preview, "save-theme-preview", "p", "Save theme preview to file. Specify a custom theme using --theme", false);
+    parser.add_argument(build_pack, "build-pack", "b", "Pack the resource root into a single file and exit, boot picks up <resource-root>/res.pack", false);
+    parser.add_argument(replay_input, "replay-input", "i", "Replay a raw evdev recording (e.g. cat /dev/input/eventN > file) as input", false);
+    parser.add_argument(decode_input, "decode-input", "D", "Decode a raw evdev recording, print the resulting events and exit", false);
     parser.add_argument(debug_mode, "debug", "d", "Enables debug mode", false);
     parser.add_argument(flash_dirty_regions, "flash-dirty-regions", "f", "Flash dirty regions (debug mode only)", false);
+    parser.add_argument(overdraw_heatmap, "overdraw-heatmap", "o", "Color pixels by how often they were drawn in a frame (debug mode only)", false);
+    parser.add_argument(triple_buffering, "triple-buffering", "T", "Use three framebuffers, presenting does not wait for the page flip (Android only)", false);
 
     ArgsParser::ParseResult result = parser.parse(argc, argv);
 
@@ -124,122 +183,30 @@ const std::string try_parse_arguments(int argc, const char* argv[]) {
     ResourceManagerBase::set_resource_root(resource_root);
     Settings::the().set<std::string>("resource-root", resource_root);
 
-    if (!save_theme_preview.empty())
-        Settings::the().set<std::string>("preview-path", save_theme_preview);
-
-    Settings::the().set<bool>("debug", debug_mode);
-    Settings::the().set<bool>("flash-dirty-regions", flash_dirty_regions);
-
-    return "";
-}
-
-void on_sigint(int) {
-    Application::the().quit(0);
-}
-
-static void register_signal_handlers() {
-    // std::atexit(on_exit);
-    struct sigaction sa{};
-    sa.sa_handler = on_sigint;
-    sigemptyset(&sa.sa_mask);
-    sigaction(SIGINT, &sa, nullptr);
-}
-
-int main(int argc, const char* argv[]) {
-    register_signal_handlers();
-
-    auto parse_error = try_parse_arguments(argc, argv);
-    if (!parse_error.empty()) {
-        LogError("Error parsing arguments: {}", parse_error);
-        return 1;
+    if (!build_pack.empty()) {
+        std::exit(ResourcePack::build(ResourceManagerBase::resource_root(), build_pack) ? 0 : 1);
     }
 
-    // Logger::the().enable_logging_to_file();
-
-    LogInfo("Izotrox v{}.{}.{} Booting... (compiled on {}, {})",
-            IZO_VERSION_MAJOR, IZO_VERSION_MINOR, IZO_VERSION_REVISION,
-            IZO_BUILD_DATE, IZO_BUILD_TIME);
-
-    bool headless = Settings::the().has("preview-path");
-    LogTrace("Headless mode: {}", headless);
-    auto theme_name = Settings::the().get<std::string>("theme-name");
-    std::string theme_path = "themes/" + theme_name + ".ini";
-
-    if (!ThemeDB::the().load(theme_path)) {
-        LogWarn("Failed to load theme '{}', falling back to 'default.ini'", theme_path);
-
-        if (!ThemeDB::the().load("themes/default.ini")) {
-            LogError("Unable to load the default theme! Izotrox might behave unexpectedly, and some colors might be missing!");
-        }
+    if (!decode_input.empty()) {
+        std::exit(print_decoded_input(decode_input) ? 0 : 1);
     }
 
-    int width = 800;
-    int height = 600;
-    bool running = true;
-
-    Application app(width, height, "Izotrox");
-    if (!app.init()) {
-        LogFatal("Failed to initialize application!");
-        return 1;
-    }
-
-    width = app.width();
-    height = app.height();
-
-    app.set_debug(Settings::the().get_or<bool>("debug", true));
-
-    auto canvas = std::make_unique<Canvas>(width, height);
-    Painter painter(std::move(canvas));
-
-    auto systemFont = FontManager::the().get_or_crash("system-ui");
-
-    if (!systemFont) {
-        LogFatal("Could not load system font!");
-        return 1;
-    }
-
-    ImageManager::the().load("slider-handle", "icons/slider-handle.png");
-    ImageManager::the().load("slider-handle-focus", "icons/slider-handle-focus.png");
-
-    if (headless) {
-        auto preview_path = Settings::the().get<std::string>("preview-path");
-        auto preview_view = ThemePreviewView::create();
-        painter.canvas()->clear(ThemeDB::the().get<Color>("Colors", "Window.Background", Color(255)));
-
-        int w = painter.canvas()->width();
-        int h = painter.canvas()->height();
-        ViewManager::the().resize(w, h);
-        ViewManager::the().push(std::move(preview_view), ViewTransition::None);
-        ViewManager::the().update();
-        ViewManager::the().draw(painter);
-
-        // Save to file
-        if (painter.canvas()->save_to_file(preview_path)) {
-            LogInfo("Theme preview saved to {}", preview_path);
-            return 0;
-        } else {
-            LogError("Failed to save theme preview to {}", preview_path);
-            return 1;
-        }
-    }
-
-    SplashScreen splash(app, painter, *painter.canvas(), *systemFont);
-
-    splash.set_total_steps(5);
-
-    splash.next_step("Initializing Input...");
-    Input::the().init();
-
-    splash.next_step("Loading Images...");
-
-    splash.next_step("Loading Fonts...");
+    if (!save_theme_preview.empty())
+        Settings::the().set<std::string>("preview-path", save_theme_preview);
 
-    auto inconsolata = FontManager::the().load("inconsolata", "fonts/Inconsolata-Regular.ttf", 18.0f);
+    if (!replay_input.empty())
+        Settings::the().set<std::string>("replay-input", replay_input);
 
-    ToastManager::the().set_font(FontManager::the().get("system-ui"));
+    Settings::debug.set(debug_mode);
+    Settings::flash_dirty_regions.set(flash_dirty_regions);
+    Settings::overdraw_heatmap.set(overdraw_heatmap);
+    Settings::triple_buffering.set(triple_buffering);
 
-    splash.next_step("Building UI...");
+    return "";
+}
 
+/* The demo tree, built on a TaskPool worker while the display comes up */
+static std::unique_ptr<LinearLayout> build_demo_ui(bool& running) {
     auto root = std::make_unique<LinearLayout>(Orientation::Vertical);
     root->set_width(WidgetSizePolicy::MatchParent);
     root->set_height(WidgetSizePolicy::MatchParent);
@@ -339,17 +306,204 @@ int main(int argc, const char* argv[]) {
     }
     root->add_child(std::move(listview));
 
-    auto mainView = std::make_unique<View>(std::move(root));
-    ViewManager::the().push(std::move(mainView), ViewTransition::None);
-    ViewManager::the().resize(width, height);
+    return root;
+}
+
+void on_sigint(int) {
+    Application::the().quit(0);
+}
+
+static void register_signal_handlers() {
+    // std::atexit(on_exit);
+    struct sigaction sa{};
+    sa.sa_handler = on_sigint;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGINT, &sa, nullptr);
+}
+
+int main(int argc, const char* argv[]) {
+    // Starts the boot clock
+    BootProfiler::the();
+    register_signal_handlers();
+
+    std::string parse_error;
+    {
+        BootProfiler::Phase phase("Parsing arguments");
+        parse_error = try_parse_arguments(argc, argv);
+    }
+    if (!parse_error.empty()) {
+        LogError("Error parsing arguments: {}", parse_error);
+        return 1;
+    }
+
+    // Logger::the().enable_logging_to_file();
+
+    LogInfo("Izotrox v{}.{}.{} Booting... (compiled on {}, {})",
+            IZO_VERSION_MAJOR, IZO_VERSION_MINOR, IZO_VERSION_REVISION,
+            IZO_BUILD_DATE, IZO_BUILD_TIME);
+
+    // Served instead of the loose files below the resource root when present
+    ResourcePack::the().open(ResourceManagerBase::resource_root() + ResourcePack::kFileName, ResourceManagerBase::resource_root());
+
+    bool headless = Settings::the().has("preview-path");
+    LogTrace("Headless mode: {}", headless);
+    auto theme_name = Settings::the().get<std::string>("theme-name");
+    std::string theme_path = "themes/" + theme_name + ".ini";
+
+    int width = 800;
+    int height = 600;
+    bool running = true;
+
+    Application app(width, height, "Izotrox");
+    std::optional<Painter> painter_storage;
+    FontManager::Handle systemFont;
+    std::optional<SplashScreen> splash;
+    std::unique_ptr<LinearLayout> root;
+    FontManager::Handle inconsolata;
+
+    // Images and fonts are only referenced through handles and may be
+    // evicted and reloaded once nothing holds them anymore
+    ImageManager::the().set_memory_budget(32 * 1024 * 1024);
+    FontManager::the().set_memory_budget(4 * 1024 * 1024);
+
+    // Independent steps overlap, e.g. the theme and system font are loaded
+    // and the UI tree is built while the display is brought up
+    BootGraph boot;
+
+    auto load_theme = boot.add("Loading theme", BootGraph::Thread::Worker, [&]() {
+        if (!ThemeDB::the().load(theme_path)) {
+            LogWarn("Failed to load theme '{}', falling back to 'default.ini'", theme_path);
+
+            if (!ThemeDB::the().load("themes/default.ini")) {
+                LogError("Unable to load the default theme! Izotrox might behave unexpectedly, and some colors might be missing!");
+            }
+        }
+
+        // Rasterized by the theme load, it names the font family
+        systemFont = FontManager::the().acquire_or_crash("system-ui");
+        if (!systemFont) {
+            LogError("Could not load system font!");
+            return false;
+        }
+        return true;
+    });
+
+    auto init_display = boot.add("Initializing display", BootGraph::Thread::UI, [&]() {
+        if (!app.init()) {
+            LogError("Failed to initialize application!");
+            return false;
+        }
+
+        width = app.width();
+        height = app.height();
+
+        app.set_debug(Settings::debug.get());
+        Settings::debug.observe([](bool enabled) { Application::the().set_debug(enabled); });
+
+        painter_storage.emplace(std::make_unique<Canvas>(width, height));
+        return true;
+    });
+
+    if (!headless) {
+        boot.add("Initializing input", BootGraph::Thread::Worker, []() {
+            Input::the().init();
+            if (Settings::the().has("replay-input")) {
+                Input::the().start_replay(Settings::the().get<std::string>("replay-input"));
+            }
+            return true;
+        });
+
+        boot.add("Showing splash", BootGraph::Thread::UI, [&]() {
+            splash.emplace(app, *painter_storage, *painter_storage->canvas(), *systemFont.get());
+            // Every step, plus "Ready!"
+            splash->set_total_steps(static_cast<int>(boot.size()) + 1);
+            splash->next_step("Booting...");
+            return true;
+        }, {load_theme, init_display});
+
+        // Decoded on TaskPool workers while the UI is being built, image
+        // handles show the theme's placeholder until the resource is in place
+        auto queue_assets = boot.add("Queueing assets", BootGraph::Thread::UI, [&]() {
+            auto redraw_when_ready = [](auto*) { ViewManager::the().invalidate_full(); };
+            static const ThemeKey k_placeholder{"Colors", "Image.Placeholder"};
+            ImageManager::the().set_placeholder(
+                std::make_unique<Image>(16, 16, ThemeDB::the().get<Color>(k_placeholder, Color(128, 128, 128))));
+            ImageManager::the().load_async("slider-handle", "icons/slider-handle.png", redraw_when_ready);
+            ImageManager::the().load_async("slider-handle-focus", "icons/slider-handle-focus.png", redraw_when_ready);
+            inconsolata = FontManager::the().load_async("inconsolata", "fonts/Inconsolata-Regular.ttf", redraw_when_ready, 18.0f);
+            return true;
+        }, {load_theme});
+
+        auto build_ui = boot.add("Building UI", BootGraph::Thread::Worker, [&]() {
+            root = build_demo_ui(running);
+            return true;
+        }, {queue_assets});
+
+        boot.add("Showing UI", BootGraph::Thread::UI, [&]() {
+            auto mainView = std::make_unique<View>(std::move(root));
+            ViewManager::the().push(std::move(mainView), ViewTransition::None);
+            ViewManager::the().resize(width, height);
+
+            // Picks up edits from tools/theme_editor and other asset changes live
+            AssetWatcher::the().start();
+            return true;
+        }, {build_ui, init_display});
+
+        boot.on_step_finished([&](const std::string& name) {
+            if (splash) splash->next_step(name);
+        });
+    }
+
+    if (!boot.run()) {
+        LogFatal("Failed to boot!");
+        return 1;
+    }
 
-    splash.next_step("Ready!");
+    Painter& painter = *painter_storage;
+
+    if (headless) {
+        // The preview is drawn right away, so nothing can arrive later
+        ImageManager::the().acquire_or_load("slider-handle", "icons/slider-handle.png");
+        ImageManager::the().acquire_or_load("slider-handle-focus", "icons/slider-handle-focus.png");
+
+        auto preview_path = Settings::the().get<std::string>("preview-path");
+        auto preview_view = ThemePreviewView::create();
+        painter.canvas()->clear(ThemeDB::the().get<Color>("Colors", "Window.Background", Color(255)));
+
+        int w = painter.canvas()->width();
+        int h = painter.canvas()->height();
+        ViewManager::the().resize(w, h);
+        ViewManager::the().push(std::move(preview_view), ViewTransition::None);
+        ViewManager::the().update();
+        ViewManager::the().draw(painter);
+
+        // Save to file
+        if (painter.canvas()->save_to_file(preview_path)) {
+            LogInfo("Theme preview saved to {}", preview_path);
+            return 0;
+        } else {
+            LogError("Failed to save theme preview to {}", preview_path);
+            return 1;
+        }
+    }
+
+    splash->next_step("Ready!");
+
+    // The UI thread records frames, the render thread draws and presents
+    // them while the next one is being built
+    Painter recorder(width, height);
+    RenderThread render_thread(app, painter);
+    RecordedFrame frame;
+    ResourceManagerBase::set_reader_fence([&]() { render_thread.wait_idle(); });
+    render_thread.start();
 
     app.on_resize([&](int w, int h) {
         width = w;
         height = h;
+        render_thread.wait_idle();
         painter.canvas()->resize(w, h);
         painter.reset_clips_and_transform();
+        recorder.set_size(w, h);
         ViewManager::the().resize(w, h);
     });
 
@@ -357,21 +511,51 @@ int main(int argc, const char* argv[]) {
     int frame_count = 0;
     float fps_timer = 0;
     float current_fps = 0;
-    IntPoint last_touch_point = Input::the().touch_point();
-    bool last_touch_down = Input::the().touch_down();
     struct FlashClearRect {
         IntRect rect;
         long long clear_at_ms;
     };
     std::vector<FlashClearRect> flash_clear_rects;
     std::vector<IntRect> clear_rects_due_this_frame;
+    // Where the last overdraw heatmap went into the canvas
+    std::vector<IntRect> heatmap_shown_rects;
+
+    FrameScheduler::the().set_refresh_period(app.refresh_period());
 
     while (running) {
+        // Block until input, a UI post or the next scheduled update unless
+        // something animates
+        bool waited = false;
+        if (!ViewManager::the().needs_redraw() && !ToastManager::the().has_active_toast()) {
+            app.wait_events(ViewManager::the().ms_until_scheduled_update());
+            waited = true;
+        }
+
+        // Then hold the frame back until its start time, so it works with
+        // the latest input and still makes its vsync
+        for (int ms = FrameScheduler::the().ms_until_frame_start(); ms > 0;
+             ms = FrameScheduler::the().ms_until_frame_start()) {
+            app.wait_events(ms);
+            // SDL leaves events queued until they are pumped, a pending one
+            // would end every further wait right away
+            if (!app.pump_events()) {
+                running = false;
+                break;
+            }
+        }
+        frame.timing = FrameScheduler::the().begin_frame();
+
         auto now = std::chrono::high_resolution_clock::now();
         const long long now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count();
         float dt = std::chrono::duration<float, std::chrono::milliseconds::period>(now - last_time).count();
         last_time = now;
 
+        // Time spent blocked belongs to the scheduled update that ended the
+        // wait, an animation started by input must not skip ahead by it
+        if (waited && ViewManager::the().ms_until_scheduled_update() != 0) {
+            dt = std::min(dt, kMaxIdleDeltaMs);
+        }
+
         app.set_delta(dt);
 
         frame_count++;
@@ -386,31 +570,39 @@ int main(int argc, const char* argv[]) {
             running = false;
         }
 
-        IntPoint tp = Input::the().touch_point();
-        bool down = Input::the().touch_down();
-        bool touch_changed = (tp != last_touch_point || down != last_touch_down);
-        if (tp != last_touch_point || down != last_touch_down) {
-            ViewManager::the().on_touch(tp, down);
-            last_touch_point = tp;
-            last_touch_down = down;
-        }
-
-        KeyCode key = Input::the().key();
-        if (key != KeyCode::None) {
-            int key_val = static_cast<int>(key);
-            bool open_shell_dialog =
-                Input::the().ctrl() &&
-                Input::the().shift() &&
-                (key_val == 'd' || key_val == 'D');
-
-            if (open_shell_dialog && !ViewManager::the().has_active_dialog()) {
-                ViewManager::the().open_dialog(std::make_unique<IzoShellDialog>());
-            } else {
-                ViewManager::the().on_key(key);
+        // Finished async loads and asset reloads
+        TaskPool::the().dispatch_ui_jobs();
+
+        // Every event in order, the Input getters follow along so widgets
+        // see the state as of the event they are handling
+        bool had_input_event = false;
+        Input::the().poll_events();
+        InputEvent event;
+        while (Input::the().next_event(event)) {
+            had_input_event = true;
+            switch (event.type) {
+                case InputEventType::TouchDown:
+                case InputEventType::TouchMove:
+                case InputEventType::TouchUp:
+                    ViewManager::the().on_touch(event.point, event.down);
+                    break;
+                case InputEventType::Key: {
+                    int key_val = static_cast<int>(event.key);
+                    bool open_shell_dialog = event.ctrl && event.shift && (key_val == 'd' || key_val == 'D');
+
+                    if (open_shell_dialog && !ViewManager::the().has_active_dialog()) {
+                        ViewManager::the().open_dialog(std::make_unique<IzoShellDialog>());
+                    } else {
+                        ViewManager::the().on_key(event.key);
+                    }
+                    break;
+                }
+                case InputEventType::Scroll:
+                    // Accumulated, ViewManager::update() consumes it
+                case InputEventType::Modifiers:
+                    break;
             }
         }
-        bool has_scroll_input = Input::the().peek_scroll_y() != 0;
-        bool had_input_event = touch_changed || key != KeyCode::None || has_scroll_input;
 
         bool should_process_frame =
             had_input_event ||
@@ -418,7 +610,6 @@ int main(int argc, const char* argv[]) {
             ToastManager::the().has_active_toast();
 
         if (!should_process_frame) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(8));
             continue;
         }
 
@@ -429,7 +620,7 @@ int main(int argc, const char* argv[]) {
             ViewManager::the().invalidate_full();
         }
 
-        const bool flash_dirty_regions = app.debug_mode() && Settings::the().get_or<bool>("flash-dirty-regions", false);
+        const bool flash_dirty_regions = app.debug_mode() && Settings::flash_dirty_regions.get();
         if (flash_dirty_regions) {
             clear_rects_due_this_frame.clear();
             for (auto it = flash_clear_rects.begin(); it != flash_clear_rects.end();) {
@@ -438,6 +629,7 @@ int main(int argc, const char* argv[]) {
                     ViewManager::the().invalidate_rect(it->rect);
                     it = flash_clear_rects.erase(it);
                 } else {
+                    ViewManager::the().schedule_update(static_cast<float>(it->clear_at_ms - now_ms));
                     ++it;
                 }
             }
@@ -447,24 +639,55 @@ int main(int argc, const char* argv[]) {
         }
 
         std::vector<IntRect> dirty_rects = ViewManager::the().consume_dirty_rects();
+        std::vector<ScrollBlit> scroll_blits = ViewManager::the().consume_scroll_blits();
 
-        if (dirty_rects.empty()) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        if (dirty_rects.empty() && scroll_blits.empty()) {
             continue;
         }
 
-        Color window_bg = ThemeDB::the().get<Color>("Colors", "Window.Background", Color(255));
-        painter.reset_clips_and_transform();
+        static const ThemeKey k_window_bg{"Colors", "Window.Background"};
+        Color window_bg = ThemeDB::the().get<Color>(k_window_bg, Color(255));
+        recorder.reset_clips_and_transform();
+        recorder.set_recording(&frame.commands);
+
+        frame.show_overdraw = app.debug_mode() && Settings::overdraw_heatmap.get();
+        if (frame.show_overdraw) {
+            frame.heatmap_rects = dirty_rects;
+        }
+
+        // The heatmap is blended into the canvas, so the next frame repaints
+        // what it covered, including scroll areas that would move it along
+        for (const auto& shown : heatmap_shown_rects) {
+            bool redrawn = std::any_of(dirty_rects.begin(), dirty_rects.end(),
+                                       [&](const IntRect& rect) { return rect.contains(shown); });
+            if (!redrawn) dirty_rects.push_back(shown);
+        }
+        for (const auto& blit : scroll_blits) {
+            bool carries_heat = std::any_of(heatmap_shown_rects.begin(), heatmap_shown_rects.end(),
+                                            [&](const IntRect& shown) { return shown.intersects(blit.rect); });
+            if (carries_heat) dirty_rects.push_back(blit.rect);
+        }
+        heatmap_shown_rects = frame.heatmap_rects;
+
+        // Scrolled content is moved on the canvas first, dirty rects only cover what it exposed
+        frame.present_rects = dirty_rects;
+        for (const auto& blit : scroll_blits) {
+            frame.commands.scroll_rect(blit.rect, blit.dy);
+            frame.present_rects.push_back(blit.rect);
+        }
+
         for (const auto& rect : dirty_rects) {
             IntRect clipped = rect.intersection({0, 0, width, height});
             if (clipped.w <= 0 || clipped.h <= 0) continue;
 
-            painter.set_global_alpha(1.0f);
-            painter.push_clip(clipped);
-            painter.fill_rect(clipped, window_bg);
-            ViewManager::the().draw(painter);
-            ToastManager::the().draw(painter, width, height);
-            // draw_debug_panel(painter, *inconsolata, current_fps);
+            recorder.set_global_alpha(1.0f);
+            recorder.push_clip(clipped);
+            if (!ViewManager::the().is_opaque_in(clipped)) {
+                recorder.fill_rect(clipped, window_bg);
+            }
+            ViewManager::the().draw(recorder);
+            ToastManager::the().draw(recorder, width, height);
+            // draw_debug_panel(recorder, *inconsolata, current_fps);
 
             if (flash_dirty_regions) {
                 bool from_scheduled_clear = false;
@@ -476,7 +699,7 @@ int main(int argc, const char* argv[]) {
                 }
 
                 if (!from_scheduled_clear) {
-                    painter.fill_rect(clipped, Color(255, 64, 192, 170));
+                    recorder.fill_rect(clipped, Color(255, 64, 192, 170));
 
                     bool merged = false;
                     for (auto& pending : flash_clear_rects) {
@@ -494,15 +717,22 @@ int main(int argc, const char* argv[]) {
                     if (!merged) {
                         flash_clear_rects.push_back({clipped, now_ms + 10});
                     }
+                    ViewManager::the().schedule_update(10.0f);
                 }
             }
 
-            painter.pop_clip();
+            recorder.pop_clip();
         }
 
-        app.present(*painter.canvas(), dirty_rects);
+        recorder.set_recording(nullptr);
+        render_thread.submit(frame);
     }
 
+    AssetWatcher::the().stop();
+    TaskPool::the().stop();
+    render_thread.stop();
+    ResourceManagerBase::set_reader_fence(nullptr);
+
     LogInfo("Bye!");
     painter.canvas()->clear(Color::Black);
     app.present(*painter.canvas());
@@ -0,0 +1,155 @@
+#!/usr/bin/env python3
+"""Recorded evdev streams for --replay-input.
+
+  input_replay.py generate          rewrite the recordings in tools/input_fixtures
+  input_replay.py check <binary>    decode each recording with --decode-input and
+                                    compare the events against the expected ones
+
+Recordings hold raw struct input_event records in the layout of a 64-bit
+kernel, the same bytes `cat /dev/input/eventN > file` produces there.
+"""
+import struct
+import subprocess
+import sys
+from pathlib import Path
+
+FIXTURE_DIR = Path(__file__).resolve().parent / "input_fixtures"
+
+EV_SYN, EV_KEY, EV_ABS = 0x00, 0x01, 0x03
+SYN_REPORT, SYN_DROPPED = 0, 3
+KEY_ENTER, KEY_LEFTSHIFT, KEY_A, KEY_S, KEY_D = 28, 42, 30, 31, 32
+BTN_TOUCH = 0x14a
+ABS_MT_SLOT, ABS_MT_POSITION_X, ABS_MT_POSITION_Y, ABS_MT_TRACKING_ID = 0x2f, 0x35, 0x36, 0x39
+
+FRAME_US = 8000
+
+DRAG_X, DRAG_Y, DRAG_STEP, DRAG_STEPS = 400, 500, 15, 19
+
+
+class Recording:
+    def __init__(self):
+        self.events = []
+        self.time_us = 1_000_000
+
+    def event(self, type_, code, value):
+        sec, usec = divmod(self.time_us, 1_000_000)
+        self.events.append(struct.pack("<qqHHi", sec, usec, type_, code, value))
+
+    def frame(self, *events, wait_us=FRAME_US):
+        for event in events:
+            self.event(*event)
+        self.event(EV_SYN, SYN_REPORT, 0)
+        self.time_us += wait_us
+
+    def write(self, path):
+        path.write_bytes(b"".join(self.events))
+        print(f"{path.name}: {len(self.events)} events")
+
+
+def tap_and_type():
+    rec = Recording()
+    rec.frame((EV_ABS, ABS_MT_SLOT, 0), (EV_ABS, ABS_MT_TRACKING_ID, 1),
+              (EV_ABS, ABS_MT_POSITION_X, 200), (EV_ABS, ABS_MT_POSITION_Y, 150), (EV_KEY, BTN_TOUCH, 1))
+    rec.frame((EV_ABS, ABS_MT_TRACKING_ID, -1), (EV_KEY, BTN_TOUCH, 0), wait_us=100_000)
+    rec.frame((EV_KEY, KEY_LEFTSHIFT, 1), (EV_KEY, KEY_A, 1))
+    rec.frame((EV_KEY, KEY_A, 0), (EV_KEY, KEY_LEFTSHIFT, 0))
+    for key in (KEY_S, KEY_D):
+        rec.frame((EV_KEY, key, 1))
+        rec.frame((EV_KEY, key, 0))
+    rec.frame((EV_KEY, KEY_ENTER, 1))
+    rec.frame((EV_KEY, KEY_ENTER, 0))
+    return rec
+
+
+def tap_and_type_expected():
+    # Shift comes as a modifier change, the key itself is already mapped
+    return ["TouchDown 200 150", "TouchUp 200 150",
+            "Modifiers 1 0", f"Key {ord('A')}", "Modifiers 0 0",
+            f"Key {ord('s')}", f"Key {ord('d')}", "Key 13"]
+
+
+def two_finger_drag():
+    rec = Recording()
+    rec.frame((EV_ABS, ABS_MT_SLOT, 0), (EV_ABS, ABS_MT_TRACKING_ID, 10),
+              (EV_ABS, ABS_MT_POSITION_X, DRAG_X), (EV_ABS, ABS_MT_POSITION_Y, DRAG_Y), (EV_KEY, BTN_TOUCH, 1))
+    rec.frame((EV_ABS, ABS_MT_SLOT, 1), (EV_ABS, ABS_MT_TRACKING_ID, 11),
+              (EV_ABS, ABS_MT_POSITION_X, DRAG_X + 200), (EV_ABS, ABS_MT_POSITION_Y, DRAG_Y))
+    for step in range(1, DRAG_STEPS + 1):
+        rec.frame((EV_ABS, ABS_MT_SLOT, 0), (EV_ABS, ABS_MT_POSITION_Y, DRAG_Y - step * DRAG_STEP),
+                  (EV_ABS, ABS_MT_SLOT, 1), (EV_ABS, ABS_MT_POSITION_Y, DRAG_Y - step * DRAG_STEP))
+    # A kernel buffer overrun in the middle, the frame after it is dropped
+    rec.event(EV_SYN, SYN_DROPPED, 0)
+    rec.frame((EV_ABS, ABS_MT_SLOT, 0), (EV_ABS, ABS_MT_POSITION_Y, 100))
+    rec.frame((EV_ABS, ABS_MT_SLOT, 0), (EV_ABS, ABS_MT_TRACKING_ID, -1))
+    rec.frame((EV_ABS, ABS_MT_SLOT, 1), (EV_ABS, ABS_MT_TRACKING_ID, -1), (EV_KEY, BTN_TOUCH, 0))
+    return rec
+
+
+def two_finger_drag_expected():
+    # One press that follows slot 0 only, nothing from the frame after the
+    # overrun, and slot 1 staying down after slot 0 lifted is no new press
+    last_y = DRAG_Y - DRAG_STEPS * DRAG_STEP
+    moves = [f"TouchMove {DRAG_X} {DRAG_Y - step * DRAG_STEP} 1" for step in range(1, DRAG_STEPS + 1)]
+    return [f"TouchDown {DRAG_X} {DRAG_Y}"] + moves + [f"TouchUp {DRAG_X} {last_y}"]
+
+
+FIXTURES = {
+    "tap_and_type.evdev": (tap_and_type, tap_and_type_expected),
+    "two_finger_drag.evdev": (two_finger_drag, two_finger_drag_expected),
+}
+
+EVENT_NAMES = ("TouchDown", "TouchMove", "TouchUp", "Key", "Scroll", "Modifiers")
+
+
+def cmd_generate():
+    FIXTURE_DIR.mkdir(exist_ok=True)
+    for name, (build, _) in FIXTURES.items():
+        build().write(FIXTURE_DIR / name)
+
+
+def decode(binary, path, timeout_s=10):
+    """Decoded events of a recording, None if the binary failed"""
+    try:
+        proc = subprocess.run([binary, "--decode-input", str(path)], capture_output=True, text=True,
+                              timeout=timeout_s)
+    except subprocess.TimeoutExpired:
+        return None
+    if proc.returncode != 0:
+        return None
+    # Log lines go to stdout as well
+    return [line for line in proc.stdout.splitlines() if line.split(" ", 1)[0] in EVENT_NAMES]
+
+
+def cmd_check(binary):
+    failed = False
+    for name, (_, expected) in FIXTURES.items():
+        events = decode(binary, FIXTURE_DIR / name)
+        want = expected()
+        if events is None:
+            print(f"FAIL  {name}: --decode-input failed")
+            failed = True
+        elif events != want:
+            print(f"FAIL  {name}:")
+            for i in range(max(len(events), len(want))):
+                got_line = events[i] if i < len(events) else "-"
+                want_line = want[i] if i < len(want) else "-"
+                mark = "  " if got_line == want_line else "! "
+                print(f"  {mark}{got_line:<24} expected {want_line}")
+            failed = True
+        else:
+            print(f"ok    {name} ({len(events)} events)")
+    return 1 if failed else 0
+
+
+def main():
+    if len(sys.argv) >= 2 and sys.argv[1] == "generate":
+        cmd_generate()
+        return 0
+    if len(sys.argv) == 3 and sys.argv[1] == "check":
+        return cmd_check(sys.argv[2])
+    print(__doc__.strip())
+    return 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())